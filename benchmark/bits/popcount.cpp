@@ -0,0 +1,54 @@
+#include "../../test/xoroshiro128pp.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sux/support/Popcount.hpp>
+#include <vector>
+
+using namespace std;
+using namespace sux;
+
+#define REPEATS 10
+
+// Keeps the compiler from coalescing repeated counts of the same memory
+static inline void barrier() { __asm__ __volatile__("" : : : "memory"); }
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s NUMWORDS\n", argv[0]);
+		return 0;
+	}
+
+	const uint64_t n = strtoll(argv[1], NULL, 0);
+	vector<uint64_t> words(n), counts(2 * (n / 8 + 1));
+	for (uint64_t i = 0; i < n; i++) words[i] = next();
+	uint64_t u = 0;
+
+	auto begin = chrono::high_resolution_clock::now();
+	for (int k = REPEATS; k-- != 0;) {
+		for (uint64_t i = 0; i < n; i++) u += __builtin_popcountll(words[i]);
+		barrier();
+	}
+	auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+	printf("scalar:       %.3f GB/s\n", REPEATS * n * 8 / (double)elapsed);
+
+	begin = chrono::high_resolution_clock::now();
+	for (int k = REPEATS; k-- != 0;) {
+		u += popcount(words.data(), n);
+		barrier();
+	}
+	elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+	printf("popcount:     %.3f GB/s\n", REPEATS * n * 8 / (double)elapsed);
+
+	begin = chrono::high_resolution_clock::now();
+	for (int k = REPEATS; k-- != 0;) {
+		u += rank9_counts(words.data(), n, counts.data());
+		barrier();
+	}
+	elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+	printf("rank9_counts: %.3f GB/s\n", REPEATS * n * 8 / (double)elapsed);
+
+	const volatile uint64_t __attribute__((unused)) unused = u;
+	return 0;
+}
@@ -1,14 +1,22 @@
 #include "../../test/xoroshiro128pp.hpp"
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <climits>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <iostream>
 #include <sux/bits/EliasFano.hpp>
+#include <sux/bits/InterleavedRank.hpp>
 #include <sux/bits/Rank9Sel.hpp>
+#include <sux/bits/RunLengthRankSel.hpp>
 #include <sux/bits/SimpleSelect.hpp>
 #include <sux/bits/SimpleSelectHalf.hpp>
+#include <sux/bits/SimpleSelectTuner.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 using namespace std;
 
@@ -17,9 +25,193 @@ using namespace std;
 using namespace sux;
 using namespace sux::bits;
 
+// Times rank() on a reference of type R: with R the type of the structure calls are bound statically, with R = Rank dynamically
+template <typename R> __attribute__((noinline)) double time_rank(R &rs, const uint64_t num_bits, const uint64_t num_pos, uint64_t &u) {
+	auto begin = chrono::high_resolution_clock::now();
+
+	for (int k = REPEATS; k-- != 0;) {
+		s[0] = 0x333e2c3815b27604;
+		s[1] = 0x47ed6e7691d8f09f;
+		for (int i = 0; i < num_pos; i++) u ^= rs.rank(remap128(next() ^ u, num_bits));
+	}
+
+	auto end = chrono::high_resolution_clock::now();
+	return chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+}
+
+// Times select() on a reference of type S: with S the type of the structure calls are bound statically, with S = Select dynamically
+template <typename S> __attribute__((noinline)) double time_select(S &rs, const uint64_t num_ones_first_half, const uint64_t num_ones_second_half, const uint64_t num_pos, uint64_t &u) {
+	auto begin = chrono::high_resolution_clock::now();
+
+	for (int k = REPEATS; k-- != 0;) {
+		s[0] = 0x333e2c3815b27604;
+		s[1] = 0x47ed6e7691d8f09f;
+		for (int i = 0; i < num_pos; i++) u ^= rs.select((u & 1) ? remap128(next(), num_ones_first_half) : num_ones_first_half + remap128(next(), num_ones_second_half));
+	}
+
+	auto end = chrono::high_resolution_clock::now();
+	return chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+}
+
+// Times select() both statically and, if the structure implements Select, dynamically
+template <typename T> void benchmark_select(T &rs, const uint64_t num_ones_first_half, const uint64_t num_ones_second_half, const uint64_t num_pos, uint64_t &u) {
+	double secs = time_select<T>(rs, num_ones_first_half, num_ones_second_half, num_pos, u);
+	printf("%f s, %f selects/s, %f ns/select\n", secs, (REPEATS * num_pos) / secs, 1E9 * secs / (REPEATS * num_pos));
+	if constexpr (is_base_of_v<Select, T>) {
+		secs = time_select<Select>(rs, num_ones_first_half, num_ones_second_half, num_pos, u);
+		printf("%f s, %f selects/s, %f ns/select (virtual)\n", secs, (REPEATS * num_pos) / secs, 1E9 * secs / (REPEATS * num_pos));
+	}
+}
+
+template <typename T, typename = void> struct has_batch_rank : false_type {};
+template <typename T> struct has_batch_rank<T, void_t<decltype(declval<T &>().rank((const size_t *)nullptr, (uint64_t *)nullptr, 0))>> : true_type {};
+
+template <typename T, typename = void> struct has_batch_select : false_type {};
+template <typename T> struct has_batch_select<T, void_t<decltype(declval<T &>().select((const uint64_t *)nullptr, (uint64_t *)nullptr, 0))>> : true_type {};
+
+// Times rank() on batches of independent positions, both one at a time and, if available, with the batch API
+template <typename T> void benchmark_batch_rank(T &rs, const uint64_t num_bits, const uint64_t num_pos, const size_t batch, uint64_t &u) {
+	vector<size_t> pos(batch);
+	vector<uint64_t> out(batch);
+	double single = 0, batched = 0;
+
+	for (int k = REPEATS; k-- != 0;) {
+		s[0] = 0x333e2c3815b27604;
+		s[1] = 0x47ed6e7691d8f09f;
+		for (uint64_t i = 0; i < num_pos; i += batch) {
+			const size_t n = min<uint64_t>(batch, num_pos - i);
+			for (size_t j = 0; j < n; j++) pos[j] = remap128(next(), num_bits);
+
+			auto begin = chrono::high_resolution_clock::now();
+			for (size_t j = 0; j < n; j++) u ^= rs.rank(pos[j]);
+			auto end = chrono::high_resolution_clock::now();
+			single += chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+
+			if constexpr (has_batch_rank<T>::value) {
+				begin = chrono::high_resolution_clock::now();
+				rs.rank(pos.data(), out.data(), n);
+				for (size_t j = 0; j < n; j++) u ^= out[j];
+				end = chrono::high_resolution_clock::now();
+				batched += chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+			}
+		}
+	}
+
+	printf("%f s, %f ranks/s, %f ns/rank (independent)\n", single, (REPEATS * num_pos) / single, 1E9 * single / (REPEATS * num_pos));
+	if constexpr (has_batch_rank<T>::value) printf("%f s, %f ranks/s, %f ns/rank (batch %zu)\n", batched, (REPEATS * num_pos) / batched, 1E9 * batched / (REPEATS * num_pos), batch);
+}
+
+// Times select() on batches of independent ranks, both one at a time and, if available, with the batch API
+template <typename T> void benchmark_batch_select(T &rs, const uint64_t num_ones_first_half, const uint64_t num_ones_second_half, const uint64_t num_pos, const size_t batch, uint64_t &u) {
+	vector<uint64_t> rank(batch), out(batch);
+	double single = 0, batched = 0;
+
+	for (int k = REPEATS; k-- != 0;) {
+		s[0] = 0x333e2c3815b27604;
+		s[1] = 0x47ed6e7691d8f09f;
+		for (uint64_t i = 0; i < num_pos; i += batch) {
+			const size_t n = min<uint64_t>(batch, num_pos - i);
+			for (size_t j = 0; j < n; j++) {
+				const uint64_t r = next();
+				rank[j] = (r & 1) ? remap128(r, num_ones_first_half) : num_ones_first_half + remap128(r, num_ones_second_half);
+			}
+
+			auto begin = chrono::high_resolution_clock::now();
+			for (size_t j = 0; j < n; j++) u ^= rs.select(rank[j]);
+			auto end = chrono::high_resolution_clock::now();
+			single += chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+
+			if constexpr (has_batch_select<T>::value) {
+				begin = chrono::high_resolution_clock::now();
+				rs.select(rank.data(), out.data(), n);
+				for (size_t j = 0; j < n; j++) u ^= out[j];
+				end = chrono::high_resolution_clock::now();
+				batched += chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+			}
+		}
+	}
+
+	printf("%f s, %f selects/s, %f ns/select (independent)\n", single, (REPEATS * num_pos) / single, 1E9 * single / (REPEATS * num_pos));
+	if constexpr (has_batch_select<T>::value) printf("%f s, %f selects/s, %f ns/select (batch %zu)\n", batched, (REPEATS * num_pos) / batched, 1E9 * batched / (REPEATS * num_pos), batch);
+}
+
+// A xoroshiro128++ generator with private state: the global state s of next() cannot be shared by threads
+class Generator {
+	uint64_t s[2];
+
+  public:
+	Generator(uint64_t seed) {
+		// Seeding by SplitMix64
+		for (uint64_t &x : s) {
+			uint64_t z = (seed += 0x9e3779b97f4a7c15);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+			x = z ^ (z >> 31);
+		}
+	}
+
+	uint64_t operator()() {
+		const uint64_t s0 = s[0];
+		uint64_t s1 = s[1];
+		const uint64_t result = rotl(s0 + s1, 17) + s0;
+
+		s1 ^= s0;
+		s[0] = rotl(s0, 49) ^ s1 ^ (s1 << 21);
+		s[1] = rotl(s1, 28);
+
+		return result;
+	}
+};
+
+/* Runs a query concurrently on an increasing number of threads, up to the given one, each with its own generator.
+ * As in the single-threaded tests, the queries of a thread depend on the result of the previous one, so the time
+ * per query of a thread is a latency; the aggregate throughput shows how memory bandwidth saturates. */
+template <typename Q> void benchmark_threads(const char *name, const size_t max_threads, const uint64_t num_pos, Q query, uint64_t &u) {
+	double base = 0;
+	for (size_t num_threads = 1;; num_threads = min(num_threads * 2, max_threads)) {
+		vector<thread> threads;
+		vector<double> secs(num_threads);
+		vector<uint64_t> result(num_threads);
+		atomic<size_t> ready(0);
+		atomic<bool> go(false);
+
+		for (size_t t = 0; t < num_threads; t++)
+			threads.emplace_back([&, t] {
+				Generator gen(t);
+				uint64_t v = 0;
+				ready++;
+				while (!go.load(memory_order_acquire)) this_thread::yield();
+				auto begin = chrono::high_resolution_clock::now();
+				for (uint64_t i = 0; i < REPEATS * num_pos; i++) v ^= query(gen() ^ v);
+				auto end = chrono::high_resolution_clock::now();
+				secs[t] = chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+				result[t] = v;
+			});
+
+		while (ready.load() < num_threads) this_thread::yield();
+		auto begin = chrono::high_resolution_clock::now();
+		go.store(true, memory_order_release);
+		for (auto &t : threads) t.join();
+		auto end = chrono::high_resolution_clock::now();
+
+		const double wall = chrono::duration_cast<chrono::nanoseconds>(end - begin).count() / 1E9;
+		double latency = 0;
+		for (size_t t = 0; t < num_threads; t++) {
+			latency += secs[t];
+			u ^= result[t];
+		}
+		latency = 1E9 * latency / (num_threads * REPEATS * num_pos);
+		const double throughput = num_threads * REPEATS * num_pos / wall;
+		if (num_threads == 1) base = throughput;
+		printf("%zu threads: %f %ss/s (%.2fx), %f ns/%s per thread\n", num_threads, throughput, name, throughput / base, latency, name);
+
+		if (num_threads == max_threads) break;
+	}
+}
+
 int main(int argc, char *argv[]) {
 	if (argc < 4) {
-		fprintf(stderr, "Usage: %s NUMBITS NUMPOS DENSITY0 [DENSITY1]\n", argv[0]);
+		fprintf(stderr, "Usage: %s NUMBITS NUMPOS DENSITY0 [DENSITY1 [BATCH [RUNLENGTH [THREADS]]]]\n", argv[0]);
 		return 0;
 	}
 
@@ -40,29 +232,52 @@ int main(int argc, char *argv[]) {
 	uint64_t *const bits = (uint64_t *)calloc(num_bits / 64 + 1, sizeof *bits);
 
 	double density0 = atof(argv[3]), density1 = argc > 4 ? atof(argv[4]) : density0;
+	// Batch mode: queries are independent, and are answered both one at a time and in batches
+	const size_t batch = argc > 5 ? strtoll(argv[5], NULL, 0) : 0;
 	assert(density0 >= 0);
 	assert(density0 <= 1);
 	assert(density1 >= 0);
 	assert(density1 <= 1);
 
-	// Init array with given density
-	const uint64_t threshold0 = (uint64_t)((UINT64_MAX)*density0), threshold1 = (uint64_t)((UINT64_MAX)*density1);
+	// Runs mode: ones are clustered in runs, and a run of ones and the following run of zeros have on average the given total length
+	const uint64_t run_length = argc > 6 ? strtoll(argv[6], NULL, 0) : 0;
 
-	uint64_t num_ones_first_half = 0, num_ones_second_half = 0;
+	// Throughput mode: a shared structure is queried by 1, 2, 4... threads, up to the given number
+	const size_t max_threads = argc > 7 ? strtoll(argv[7], NULL, 0) : 0;
 
-	for (int64_t i = 0; i < num_bits / 2; i++)
-		if (next() < threshold0) {
-			num_ones_first_half++;
-			bits[i / 64] |= 1LL << i % 64;
-		}
-	for (int64_t i = num_bits / 2; i < num_bits; i++)
-		if (next() < threshold1) {
-			num_ones_second_half++;
-			bits[i / 64] |= 1LL << i % 64;
+	// Init array with given density
+	bool one = false;
+	auto fill = [&](const uint64_t from, const uint64_t to, const double density) {
+		const uint64_t threshold = (uint64_t)((UINT64_MAX)*density);
+		// In runs mode, the probabilities of ending a run of ones and a run of zeros at each bit
+		const uint64_t end_one = density < 1 ? (uint64_t)((UINT64_MAX)*min(1.0, 1 / (run_length * density))) : 0;
+		const uint64_t end_zero = density > 0 ? (uint64_t)((UINT64_MAX)*min(1.0, 1 / (run_length * (1 - density)))) : 0;
+		uint64_t ones = 0;
+		for (uint64_t i = from; i < to; i++) {
+			if (run_length == 0)
+				one = next() < threshold;
+			else if (next() < (one ? end_one : end_zero))
+				one = !one;
+			if (one) {
+				ones++;
+				bits[i / 64] |= 1ULL << i % 64;
+			}
 		}
+		return ones;
+	};
+
+	const uint64_t num_ones_first_half = fill(0, num_bits / 2, density0), num_ones_second_half = fill(num_bits / 2, num_bits, density1);
 
 #ifdef MAX_LOG2_LONGWORDS_PER_SUBINVENTORY
 	CLASS rs(bits, num_bits, MAX_LOG2_LONGWORDS_PER_SUBINVENTORY);
+#elif defined(MAX_SPACE_PERCENT)
+	// Benchmarks the candidate settings, and picks the fastest within the given space
+	SimpleSelectTuner tuner(bits, num_bits);
+	tuner.benchmark(num_pos);
+	for (const auto &e : tuner.estimates()) cout << e << endl;
+	const auto choice = tuner.forSpace(MAX_SPACE_PERCENT / 100.0);
+	cout << "Choice: " << choice << endl;
+	CLASS rs(bits, num_bits, choice.max_log2_longwords_per_subinventory);
 #else
 	CLASS rs(bits, num_bits);
 #endif
@@ -73,35 +288,22 @@ int main(int argc, char *argv[]) {
 
 #ifndef NORANKTEST
 
-	auto begin = chrono::high_resolution_clock::now();
-
-	for (int k = REPEATS; k-- != 0;) {
-		s[0] = 0x333e2c3815b27604;
-		s[1] = 0x47ed6e7691d8f09f;
-		for (int i = 0; i < num_pos; i++) u ^= rs.rank(remap128(next() ^ u, num_bits));
-	}
-
-	auto end = chrono::high_resolution_clock::now();
-	const uint64_t elapsed = chrono::duration_cast<chrono::nanoseconds>(end - begin).count();
-	const double secs = elapsed / 1E9;
+	double secs = time_rank<decltype(rs)>(rs, num_bits, num_pos, u);
 	printf("%f s, %f ranks/s, %f ns/rank\n", secs, (REPEATS * num_pos) / secs, 1E9 * secs / (REPEATS * num_pos));
+	secs = time_rank<Rank>(rs, num_bits, num_pos, u);
+	printf("%f s, %f ranks/s, %f ns/rank (virtual)\n", secs, (REPEATS * num_pos) / secs, 1E9 * secs / (REPEATS * num_pos));
+	if (batch) benchmark_batch_rank(rs, num_bits, num_pos, batch, u);
+	if (max_threads) benchmark_threads("rank", max_threads, num_pos, [&](const uint64_t r) { return rs.rank(remap128(r, num_bits)); }, u);
 #endif
 
 #ifndef NOSELECTTEST
 
 	if (num_ones_first_half && num_ones_second_half) {
-		auto begin = chrono::high_resolution_clock::now();
-
-		for (int k = REPEATS; k-- != 0;) {
-			s[0] = 0x333e2c3815b27604;
-			s[1] = 0x47ed6e7691d8f09f;
-			for (int i = 0; i < num_pos; i++) u ^= rs.select((u & 1) ? remap128(next(), num_ones_first_half) : num_ones_first_half + remap128(next(), num_ones_second_half));
-		}
-
-		auto end = chrono::high_resolution_clock::now();
-		const uint64_t elapsed = chrono::duration_cast<chrono::nanoseconds>(end - begin).count();
-		const double secs = elapsed / 1E9;
-		printf("%f s, %f selects/s, %f ns/select\n", secs, (REPEATS * num_pos) / secs, 1E9 * secs / (REPEATS * num_pos));
+		benchmark_select(rs, num_ones_first_half, num_ones_second_half, num_pos, u);
+		if (batch) benchmark_batch_select(rs, num_ones_first_half, num_ones_second_half, num_pos, batch, u);
+		if (max_threads)
+			benchmark_threads(
+				"select", max_threads, num_pos, [&](const uint64_t r) { return rs.select((r & 1) ? remap128(r, num_ones_first_half) : num_ones_first_half + remap128(r, num_ones_second_half)); }, u);
 	} else
 		printf("Too few ones to measure select speed\n");
 #endif
@@ -0,0 +1,58 @@
+#include "../../test/xoroshiro128pp.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sux/support/common.hpp>
+#include <vector>
+
+using namespace std;
+using namespace sux;
+
+#define REPEATS 10
+
+// Times a select function on a list of words and ranks, both with independent calls
+// (throughput) and with calls chained through the result (latency).
+template <uint64_t (*SELECT)(uint64_t, uint64_t)> void benchmark(const char *name, const vector<uint64_t> &word, const vector<uint64_t> &rank) {
+	const size_t n = word.size();
+	uint64_t u = 0;
+
+	auto begin = chrono::high_resolution_clock::now();
+	for (int k = REPEATS; k-- != 0;)
+		for (size_t i = 0; i < n; i++) u += SELECT(word[i], rank[i]);
+	auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+	printf("%-10s throughput: %.3f ns/select\n", name, elapsed / (double)(REPEATS * n));
+
+	begin = chrono::high_resolution_clock::now();
+	for (int k = REPEATS; k-- != 0;)
+		for (size_t i = 0; i < n; i++) u = SELECT(word[i ^ (u & 1)], rank[i]);
+	elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+	printf("%-10s latency:    %.3f ns/select\n", name, elapsed / (double)(REPEATS * n));
+
+	const volatile uint64_t __attribute__((unused)) unused = u;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s NUMWORDS\n", argv[0]);
+		return 0;
+	}
+
+	const uint64_t n = strtoll(argv[1], NULL, 0) & ~UINT64_C(1);
+	vector<uint64_t> word(n), rank(n);
+	for (uint64_t i = 0; i < n; i++) {
+		// Words with at least two ones; ranks are valid for both words of a pair, as chained calls may use either
+		do word[i] = next();
+		while (nu(word[i]) < 2);
+	}
+	for (uint64_t i = 0; i < n; i++) rank[i] = next() % min(nu(word[i]), nu(word[i ^ 1]));
+
+	printf("Fast PDEP: %s\n", fast_pdep ? "yes" : "no");
+	benchmark<select64_broadword>("broadword", word, rank);
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("bmi2")) benchmark<select64_pdep>("pdep", word, rank);
+#endif
+	benchmark<select64>("select64", word, rank);
+
+	return 0;
+}
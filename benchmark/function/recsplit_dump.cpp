@@ -9,7 +9,7 @@ using namespace sux::function;
 
 int main(int argc, char **argv) {
 	if (argc < 4) {
-		fprintf(stderr, "Usage: %s <keys> <bucket size> <mpfh>\n", argv[0]);
+		fprintf(stderr, "Usage: %s <keys> <bucket size> <mpfh> [<threads>]\n", argv[0]);
 		return 1;
 	}
 
@@ -20,10 +20,11 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 	const size_t bucket_size = strtoll(argv[2], NULL, 0);
+	const size_t num_threads = argc > 4 ? strtoll(argv[4], NULL, 0) : 1;
 
 	printf("Building...\n");
 	auto begin = chrono::high_resolution_clock::now();
-	RecSplit<LEAF, ALLOC_TYPE> rs(ifs, bucket_size);
+	RecSplit<LEAF, ALLOC_TYPE> rs(ifs, bucket_size, num_threads);
 	ifs.close();
 
 	auto elapsed = chrono::duration_cast<std::chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
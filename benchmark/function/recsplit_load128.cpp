@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdio>
 #include <fstream>
+#include <inttypes.h>
 #include <iostream>
 #include <random>
 #include <sux/function/RecSplit.hpp>
@@ -34,9 +35,38 @@ void benchmark(RecSplit<LEAF, ALLOC_TYPE> &rs, const uint64_t n) {
 	printf("\nMedian: %.3fs; %.3f ns/key\n", sample[SAMPLES / 2] * 1E-9, sample[SAMPLES / 2] / (double)n);
 }
 
+void benchmark_batch(RecSplit<LEAF, ALLOC_TYPE> &rs, const uint64_t n, const uint64_t batch, const bool bucket_order) {
+	printf("Benchmarking batches of %" PRIu64 " keys (%s)...\n", batch, bucket_order ? "bucket order" : "input order");
+
+	uint64_t sample[SAMPLES];
+	uint64_t h = 0;
+	vector<hash128_t> keys;
+	vector<size_t> values(batch);
+
+	for (int k = SAMPLES; k-- != 0;) {
+		s[0] = 0x5603141978c51071;
+		s[1] = 0x3bbddc01ebdf4b72;
+		uint64_t elapsed = 0;
+		for (uint64_t i = 0; i < n; i += batch) {
+			keys.clear();
+			for (uint64_t j = 0; j < min(batch, n - i); j++) keys.push_back(hash128_t(next(), next()));
+			auto begin = chrono::high_resolution_clock::now();
+			rs(keys.data(), keys.size(), values.data(), bucket_order);
+			elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+			for (size_t j = 0; j < keys.size(); j++) h ^= values[j];
+		}
+		sample[k] = elapsed;
+		printf("Elapsed: %.3fs; %.3f ns/key\n", elapsed * 1E-9, elapsed / (double)n);
+	}
+
+	const volatile uint64_t unused = h;
+	sort(sample, sample + SAMPLES);
+	printf("\nMedian: %.3fs; %.3f ns/key\n", sample[SAMPLES / 2] * 1E-9, sample[SAMPLES / 2] / (double)n);
+}
+
 int main(int argc, char **argv) {
 	if (argc < 3) {
-		fprintf(stderr, "Usage: %s <n> <mphf>\n", argv[0]);
+		fprintf(stderr, "Usage: %s <n> <mphf> [<batch size>]\n", argv[0]);
 		return 1;
 	}
 
@@ -50,7 +80,12 @@ int main(int argc, char **argv) {
 	fs >> rs;
 	fs.close();
 
-	benchmark(rs, n);
+	if (argc > 3) {
+		const uint64_t batch = strtoll(argv[3], NULL, 0);
+		benchmark_batch(rs, n, batch, false);
+		benchmark_batch(rs, n, batch, true);
+	} else
+		benchmark(rs, n);
 
 	return 0;
 }
@@ -0,0 +1,165 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/common.hpp"
+#include "../util/Vector.hpp"
+#include "Rank9Sel.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace sux::bits {
+
+/** A growable Rank9Sel on a bit vector to which bits can only be appended.
+ *
+ * The bit vector is owned by the instance, and Rank9 counts and Select9 inventories
+ * are extended as bits are appended, so rank and select on the current content
+ * take constant time without ever rebuilding the structure. Appending takes amortized
+ * constant time per bit and per one.
+ *
+ * The inventory entry containing the last ones is incomplete, as its span is not known yet:
+ * its subinventory records provisionally the position of every one, and it is replaced by a
+ * standard Select9 subinventory as soon as the following entry starts.
+ *
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+template <util::AllocType AT = util::AllocType::MALLOC> class AppendRank9Sel : public Rank9Sel<AT> {
+  private:
+	// The subcounts of a block whose words are not complete yet; as an incomplete block contains at most 511 ones, Select9 will not move past incomplete words
+	static constexpr uint64_t INCOMPLETE_SUBCOUNTS = (UINT64_C(1) << 63) - 1;
+
+	util::Vector<uint64_t, AT> words;
+
+	/** Records a new one.
+	 *
+	 * @param pos the position of the one, which must follow all previous ones.
+	 */
+	void addOne(const uint64_t pos) {
+		const uint64_t rank = this->num_ones++;
+		const uint64_t index = rank >> this->log2_ones_per_inventory;
+
+		if ((rank & this->inventory_mask) == 0) {
+			if (index > 0) {
+				// The previous entry is now complete: its provisional subinventory is replaced by the Select9 one
+				const uint64_t first_bit = this->inventory[index - 1];
+				memset(&this->subinventory + (first_bit / 64) / 4, 0, this->ones_per_inventory * sizeof(uint64_t));
+				this->inventory[index] = pos;
+				this->template fillSubinventory<false>(this->subinventory, rank, index - 1, first_bit, pos);
+			}
+
+			// A fake following entry gives the new entry a span of ones_per_inventory subinventory words, in which positions are recorded explicitly
+			this->inventory.resize(index + 2);
+			this->inventory[index] = pos;
+			this->inventory[index + 1] = ((pos / 64) / 4 + this->ones_per_inventory) * 4 * 64;
+			this->subinventory.resize(max(this->subinventory.size(), (pos / 64) / 4 + this->ones_per_inventory));
+			this->inventory_size = index + 1;
+		}
+
+		this->subinventory[(this->inventory[index] / 64) / 4 + (rank & this->inventory_mask)] = pos;
+	}
+
+	/** Appends bits that do not cross a word boundary.
+	 *
+	 * @param value the bits to append, with no bits set beyond `width`.
+	 * @param width the number of bits to append; together with the bits in the last word, at most 64.
+	 */
+	void appendToWord(const uint64_t value, const int width) {
+		const uint64_t word = this->num_bits / 64, offset = this->num_bits % 64;
+		assert(offset + width <= 64);
+		words[word] |= value << offset;
+		for (uint64_t v = value; v != 0; v &= v - 1) addOne(this->num_bits + __builtin_ctzll(v));
+
+		this->num_bits += width;
+		// The counts of the following block act as a sentinel, as in Rank9
+		this->counts[(word / 8) * 2 + 2] = this->num_ones;
+
+		if (width != 0 && this->num_bits % 64 == 0) {
+			// The word is complete: we update the subcounts, or start a new block
+			words.pushBack(0);
+			this->bits = &words;
+			const uint64_t block = word / 8;
+			if (word % 8 < 7)
+				this->counts[block * 2 + 1] ^= (0x1FF ^ (this->num_ones - this->counts[block * 2])) << 9 * (word % 8);
+			else {
+				this->counts.resize(block * 2 + 6);
+				this->counts[block * 2 + 3] = INCOMPLETE_SUBCOUNTS;
+				this->counts[block * 2 + 4] = this->num_ones;
+			}
+		}
+	}
+
+  public:
+	/** Creates a new instance with an empty bit vector. */
+	AppendRank9Sel() {
+		// There is always a word following the last bit, so that rank(size()) is valid
+		words.resize(1);
+		this->bits = &words;
+		this->counts.resize(4);
+		this->counts[1] = INCOMPLETE_SUBCOUNTS;
+	}
+
+	/** Appends bits to the bit vector.
+	 *
+	 * @param value the bits to append, starting from the least significant one; bits beyond `width` are ignored.
+	 * @param width the number of bits to append (at most 64).
+	 */
+	void append(uint64_t value, const int width) {
+		assert(width >= 0 && width <= 64);
+		if (width < 64) value &= (UINT64_C(1) << width) - 1;
+		const int free = 64 - this->num_bits % 64;
+		if (width <= free)
+			appendToWord(value, width);
+		else {
+			appendToWord(value & ((UINT64_C(1) << free) - 1), free);
+			appendToWord(value >> free, width - free);
+		}
+	}
+
+	/** Appends a bit to the bit vector.
+	 *
+	 * @param bit the bit to append.
+	 */
+	void pushBack(const bool bit) { append(bit, 1); }
+
+	/** Returns the bit at a given position.
+	 *
+	 * @param pos a position smaller than size().
+	 */
+	bool operator[](const uint64_t pos) const { return words[pos / 64] >> pos % 64 & 1; }
+
+	/** Returns a pointer to the bit vector, which is followed by a word containing no ones.
+	 *
+	 * The pointer is invalidated by subsequent appends.
+	 */
+	const uint64_t *bitVector() const { return &words; }
+
+	size_t bitCount() const { return Rank9Sel<AT>::bitCount() - sizeof(Rank9Sel<AT>) * 8 + words.bitCount() - sizeof(words) * 8 + sizeof(*this) * 8; }
+};
+
+} // namespace sux::bits
@@ -28,9 +28,11 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "OnesIterator.hpp"
 #include "Rank.hpp"
-#include "SimpleSelectHalf.hpp"
-#include "SimpleSelectZeroHalf.hpp"
+#include "Select.hpp"
+#include "SimpleSelectBoth.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -49,20 +51,22 @@ using namespace sux;
  * @tparam AT a type of memory allocation out of sux::util::AllocType.
  */
 
-template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public Rank, public Select {
+template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public StaticRank<EliasFano<AT>>, public StaticSelect<EliasFano<AT>> {
   private:
 	util::Vector<uint64_t, AT> lower_bits, upper_bits;
-	SimpleSelectHalf<AT> select_upper;
-	SimpleSelectZeroHalf<AT> selectz_upper;
+	SimpleSelectBoth<AT> select_upper;
 	uint64_t num_bits, num_ones;
 	int l;
 	int block_size;
 	int block_length;
 	uint64_t block_size_mask;
 	uint64_t lower_l_bits_mask;
-	uint64_t ones_step_l;
-	uint64_t msbs_step_l;
-	uint64_t compressor;
+	uint64_t ones_step_l = 0;
+	uint64_t msbs_step_l = 0;
+	uint64_t compressor = 0;
+
+	// Number of queries whose memory accesses are overlapped by the batch version of select()
+	static constexpr size_t PREFETCH_BATCH = 16;
 
 	__inline static void set(util::Vector<uint64_t, AT> &bits, const uint64_t pos) { bits[pos / 64] |= 1ULL << pos % 64; }
 
@@ -101,9 +105,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 	 */
 	EliasFano(const uint64_t *const bits, const uint64_t num_bits) {
 		const uint64_t num_words = (num_bits + 63) / 64;
-		uint64_t m = 0;
-		for (uint64_t i = num_words; i-- != 0;) m += __builtin_popcountll(bits[i]);
-		num_ones = m;
+		num_ones = popcount(bits, num_words);
 		this->num_bits = num_bits;
 		l = num_ones == 0 ? 0 : max(0, lambda_safe(num_bits / num_ones));
 
@@ -134,8 +136,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		//       upper_bits[2], upper_bits[3]);
 #endif
 
-		select_upper = SimpleSelectHalf(&upper_bits, num_ones + (num_bits >> l));
-		selectz_upper = SimpleSelectZeroHalf(&upper_bits, num_ones + (num_bits >> l));
+		select_upper = SimpleSelectBoth<AT>(&upper_bits, num_ones + (num_bits >> l) + 1);
 
 		block_size = 0;
 		do
@@ -175,7 +176,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 	 * @param ones a list of positions of the ones in a bit vector.
 	 * @param num_bits the length (in bits) of the bit vector.
 	 */
-	EliasFano(const std::vector<uint64_t> ones, const uint64_t num_bits) {
+	EliasFano(const std::vector<uint64_t> &ones, const uint64_t num_bits) {
 		num_ones = ones.size();
 		this->num_bits = num_bits;
 		l = num_ones == 0 ? 0 : max(0, lambda_safe(num_bits / num_ones));
@@ -188,8 +189,8 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 
 		const uint64_t lower_bits_mask = (1ULL << l) - 1;
 
-		lower_bits = new uint64_t[(num_ones * l + 63) / 64 + 2 * (l == 0)];
-		upper_bits = new uint64_t[((num_ones + (num_bits >> l) + 1) + 63) / 64]();
+		lower_bits.size((num_ones * l + 63) / 64 + 2 * (l == 0));
+		upper_bits.size(((num_ones + (num_bits >> l) + 1) + 63) / 64);
 
 		for (uint64_t i = 0; i < num_ones; i++) {
 			if (l != 0) set_bits(lower_bits, i * l, l, ones[i] & lower_bits_mask);
@@ -201,8 +202,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		printf("First upper: %016llx %016llx %016llx %016llx\n", upper_bits[0], upper_bits[1], upper_bits[2], upper_bits[3]);
 #endif
 
-		select_upper = SimpleSelectHalf(upper_bits, num_ones + (num_bits >> l));
-		selectz_upper = SimpleSelectZeroHalf(upper_bits, num_ones + (num_bits >> l));
+		select_upper = SimpleSelectBoth<AT>(&upper_bits, num_ones + (num_bits >> l) + 1);
 
 		block_size = 0;
 		do
@@ -228,7 +228,40 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		lower_l_bits_mask = (1ULL << l) - 1;
 	}
 
-	uint64_t rank(const size_t k) {
+	/** Creates an empty instance, to be filled by the `>>` operator. */
+	EliasFano() {}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	EliasFano(const char *&image) {
+		util::view_words(image, num_bits, num_ones, l, block_size, block_length, block_size_mask, lower_l_bits_mask, ones_step_l, msbs_step_l, compressor);
+		lower_bits = util::Vector<uint64_t, AT>::view(image);
+		upper_bits = util::Vector<uint64_t, AT>::view(image);
+		select_upper = SimpleSelectBoth<AT>(&upper_bits, image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const EliasFano<AT> &ef) {
+		util::write_words(os, ef.num_bits, ef.num_ones, ef.l, ef.block_size, ef.block_length, ef.block_size_mask, ef.lower_l_bits_mask, ef.ones_step_l, ef.msbs_step_l, ef.compressor);
+		return os << ef.lower_bits << ef.upper_bits << ef.select_upper;
+	}
+
+	friend std::istream &operator>>(std::istream &is, EliasFano<AT> &ef) {
+		util::read_words(is, ef.num_bits, ef.num_ones, ef.l, ef.block_size, ef.block_length, ef.block_size_mask, ef.lower_l_bits_mask, ef.ones_step_l, ef.msbs_step_l, ef.compressor);
+		is >> ef.lower_bits >> ef.upper_bits;
+		ef.select_upper = SimpleSelectBoth<AT>(&ef.upper_bits, is);
+		return is;
+	}
+
+  private:
+	friend StaticRank<EliasFano<AT>>;
+	friend StaticSelect<EliasFano<AT>>;
+
+	SUX_MULTIVERSION uint64_t rankKernel(const size_t k) {
 		if (num_ones == 0) return 0;
 		if (k >= num_bits) return num_ones;
 #ifdef DEBUG
@@ -237,7 +270,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		const uint64_t k_shiftr_l = k >> l;
 
 #ifndef PARSEARCH
-		int64_t pos = selectz_upper.selectZero(k_shiftr_l);
+		int64_t pos = select_upper.selectZero(k_shiftr_l);
 		uint64_t rank = pos - (k_shiftr_l);
 
 #ifdef DEBUG
@@ -263,7 +296,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 
 		const uint64_t k_lower_bits_step_l = k_lower_bits * ones_step_l;
 
-		uint64_t pos = selectz_upper.selectZero(k_shiftr_l);
+		uint64_t pos = select_upper.selectZero(k_shiftr_l);
 		uint64_t rank = pos - (k_shiftr_l);
 		uint64_t rank_times_l = rank * l;
 
@@ -320,7 +353,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 #endif
 	}
 
-	size_t select(const uint64_t rank) {
+	SUX_MULTIVERSION size_t selectKernel(const uint64_t rank) {
 #ifdef DEBUG
 		printf("Selecting %lld...\n", rank);
 #endif
@@ -331,6 +364,28 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		return (select_upper.select(rank) - rank) << l | get_bits(lower_bits, rank * l, l);
 	}
 
+  public:
+	using StaticSelect<EliasFano<AT>>::select;
+
+	/** Selects a batch of ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but the lower bits
+	 * and the structures used to select in the upper bits for several ranks are prefetched
+	 * in advance, so that cache misses of different queries overlap.
+	 *
+	 * @param rank an array of `n` ranks.
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of ranks.
+	 */
+	void select(const uint64_t *rank, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			for (size_t j = base; j < base + b; j++) __builtin_prefetch((uint8_t *)&lower_bits + rank[j] * l / 8);
+			select_upper.select(rank + base, out + base, b);
+			for (size_t j = base; j < base + b; j++) out[j] = (out[j] - rank[j]) << l | get_bits(lower_bits, rank[j] * l, l);
+		}
+	}
+
 	uint64_t select(const uint64_t rank, uint64_t *const next) {
 		uint64_t s, t;
 		s = select_upper.select(rank, &t) - rank;
@@ -341,13 +396,71 @@ template <util::AllocType AT = util::AllocType::MALLOC> class EliasFano : public
 		return s << l | get_bits(lower_bits, position, l);
 	}
 
+	/** A cursor enumerating the positions of consecutive ones.
+	 *
+	 * The upper bits are scanned a word at a time, and the lower bits are read sequentially.
+	 * The iterator does not check the end of the sequence: it must not be asked for
+	 * more ones than those following its starting rank.
+	 */
+	class Iterator {
+		OnesIterator upper;
+		const uint64_t *lower_bits;
+		uint64_t rank;
+		int l;
+
+		uint64_t lower(const uint64_t rank) const {
+			const uint64_t start = rank * l;
+			const int start_bit = start % 64;
+			const uint64_t result = lower_bits[start / 64] >> start_bit;
+			return (start_bit + l <= 64 ? result : result | lower_bits[start / 64 + 1] << (64 - start_bit)) & ((1ULL << l) - 1);
+		}
+
+	  public:
+		Iterator(const uint64_t *const upper_bits, const uint64_t pos, const uint64_t *const lower_bits, const uint64_t rank, const int l)
+			: upper(upper_bits, pos), lower_bits(lower_bits), rank(rank), l(l) {}
+
+		/** Returns the position of the next one. */
+		uint64_t next() {
+			const uint64_t upper_pos = upper.next() - rank;
+			return upper_pos << l | lower(rank++);
+		}
+
+		/** Fills an array with the positions of the next ones.
+		 *
+		 * @param out an array of `n` elements that will be filled with the positions.
+		 * @param n the number of positions to enumerate.
+		 */
+		void next(uint64_t *out, const size_t n) {
+			upper.next(out, n);
+			for (size_t j = 0; j < n; j++, rank++) out[j] = (out[j] - rank) << l | lower(rank);
+		}
+	};
+
+	/** Returns an iterator on the ones of the bit vector.
+	 *
+	 * @param rank the rank of the first one returned by the iterator, which must be smaller than the number of ones.
+	 */
+	Iterator iterator(const uint64_t rank) { return Iterator(&upper_bits, select_upper.select(rank), &lower_bits, rank, l); }
+
+	/** Selects a range of consecutive ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but only the first
+	 * rank is selected: the following ones are decoded sequentially.
+	 *
+	 * @param from the first rank.
+	 * @param to the last rank (exclusive).
+	 * @param out an array of `to - from` elements that will be filled with the positions.
+	 */
+	void selectRange(const uint64_t from, const uint64_t to, uint64_t *out) {
+		if (from < to) iterator(from).next(out, to - from);
+	}
+
 	/** Returns the size in bits of the underlying bit vector. */
 	size_t size() const { return num_bits; }
 
 	/** Returns an estimate of the size in bits of this structure. */
-	uint64_t bitCount() {
-		return upper_bits.bitCount() - sizeof(upper_bits) * 8 + lower_bits.bitCount() - sizeof(lower_bits) * 8 + select_upper.bitCount() - sizeof(select_upper) * 8 + selectz_upper.bitCount() -
-			   sizeof(selectz_upper) * 8 + sizeof(*this) * 8;
+	uint64_t bitCount() const {
+		return upper_bits.bitCount() - sizeof(upper_bits) * 8 + lower_bits.bitCount() - sizeof(lower_bits) * 8 + select_upper.bitCount() - sizeof(select_upper) * 8 + sizeof(*this) * 8;
 	}
 };
 
@@ -0,0 +1,194 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/Popcount.hpp"
+#include "../support/common.hpp"
+#include "../util/Vector.hpp"
+#include "Rank.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace sux::bits {
+
+using namespace sux;
+
+/** A ranking structure storing the bit vector and its counts interleaved in cache lines.
+ *
+ * Each 64-byte cache line contains the number of ones before the line, in its first
+ * word, followed by seven words of the bit vector. Ranking needs just the line containing
+ * the position, so a random rank on a bit vector much larger than the cache causes a single
+ * cache miss, whereas Rank9 causes two (one for the counts and one for the bit vector).
+ * The space used is 8/7 of the size of the bit vector, that is, 14.3% additional space.
+ *
+ * Differently from Rank9, instances of this class own the bit vector: it can be either
+ * copied from a given array, or moved from a util::Vector and transformed in place, in
+ * which case no additional copy of the bit vector is ever allocated.
+ *
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+
+template <util::AllocType AT = util::AllocType::MALLOC> class InterleavedRank : public StaticRank<InterleavedRank<AT>> {
+  private:
+	static constexpr uint64_t WORDS_PER_LINE = 8;
+	static constexpr uint64_t BITS_PER_LINE = (WORDS_PER_LINE - 1) * 64;
+
+	// Number of queries whose memory accesses are overlapped by the batch version of rank()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	uint64_t num_bits, num_ones;
+	util::Vector<uint64_t, AT> data;
+	// The first cache-line aligned word of data
+	uint64_t *lines;
+
+	// Lines of a bit vector with the given number of bits, including a final line containing just the number of ones
+	static uint64_t numLines(const uint64_t num_bits) { return num_bits / BITS_PER_LINE + 1; }
+
+	// Sizes data so that it contains numLines() aligned lines, and sets lines
+	void alloc() {
+		data.size(numLines(num_bits) * WORDS_PER_LINE + WORDS_PER_LINE - 1);
+		lines = &data + (-(reinterpret_cast<uintptr_t>(&data) / sizeof(uint64_t)) & (WORDS_PER_LINE - 1));
+	}
+
+	// Clears the bits after the end of the bit vector and computes the counts
+	void fillCounts() {
+		const uint64_t n = numLines(num_bits);
+		if (num_bits % 64 != 0) lines[(num_bits / BITS_PER_LINE) * WORDS_PER_LINE + 1 + num_bits % BITS_PER_LINE / 64] &= (1ULL << num_bits % 64) - 1;
+		num_ones = 0;
+		for (uint64_t l = 0; l < n; l++) {
+			lines[l * WORDS_PER_LINE] = num_ones;
+			num_ones += popcount(lines + l * WORDS_PER_LINE + 1, WORDS_PER_LINE - 1);
+		}
+		assert(num_ones <= num_bits);
+	}
+
+  public:
+	/** Creates a new instance copying a given bit vector.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 */
+	InterleavedRank(const uint64_t *const bits, const uint64_t num_bits) : num_bits(num_bits) {
+		const uint64_t num_words = (num_bits + 63) / 64;
+		alloc();
+		for (uint64_t w = 0; w < num_words; w += WORDS_PER_LINE - 1)
+			memcpy(lines + w / (WORDS_PER_LINE - 1) * WORDS_PER_LINE + 1, bits + w, min(WORDS_PER_LINE - 1, num_words - w) * sizeof(uint64_t));
+		fillCounts();
+	}
+
+	/** Creates a new instance transforming in place a given bit vector.
+	 *
+	 * The vector is enlarged and its words are moved to their position in the
+	 * interleaved layout, so the peak memory usage is just that of the final structure
+	 * (plus the slack due to reallocation, if any).
+	 *
+	 * @param bits a bit vector of 64-bit words, which will be owned by this structure.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 */
+	InterleavedRank(util::Vector<uint64_t, AT> &&bits, const uint64_t num_bits) : num_bits(num_bits), data(std::move(bits)) {
+		const uint64_t num_words = (num_bits + 63) / 64;
+		assert(data.size() >= num_words);
+		alloc();
+		// A word moves from index w to index at least w + w / 7 + 1, so proceeding backwards
+		// no word is overwritten before being moved
+		uint64_t *const words = &data;
+		for (uint64_t l = numLines(num_bits); l-- != 0;) {
+			const uint64_t from = l * (WORDS_PER_LINE - 1), n = from < num_words ? min(WORDS_PER_LINE - 1, num_words - from) : 0;
+			uint64_t *const line = lines + l * WORDS_PER_LINE;
+			memmove(line + 1, words + from, n * sizeof(uint64_t));
+			memset(line + 1 + n, 0, (WORDS_PER_LINE - 1 - n) * sizeof(uint64_t));
+		}
+		fillCounts();
+	}
+
+	/** Returns the bit at a given position.
+	 *
+	 * @param pos a position smaller than size().
+	 */
+	bool operator[](const size_t pos) const { return lines[pos / BITS_PER_LINE * WORDS_PER_LINE + 1 + pos % BITS_PER_LINE / 64] >> pos % 64 & 1; }
+
+  private:
+	friend StaticRank<InterleavedRank<AT>>;
+
+#ifdef SUX_POPCOUNT_AVX512
+// GCC reports spurious uninitialized values inside some AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+	SUX_MULTIVERSION uint64_t rankKernel(const size_t pos) {
+		const uint64_t *const line = lines + pos / BITS_PER_LINE * WORDS_PER_LINE;
+		const uint64_t offset = pos % BITS_PER_LINE;
+#ifdef SUX_POPCOUNT_AVX512
+		// Lane i > 0 keeps the bits of word i - 1 before the offset (a shift of 64 or more clears a lane); lane 0, the count, is cleared
+		const __m512i shift = _mm512_max_epi64(_mm512_sub_epi64(_mm512_set_epi64(448, 384, 320, 256, 192, 128, 64, 1LL << 32), _mm512_set1_epi64(offset)), _mm512_setzero_si512());
+		const __m512i masked = _mm512_and_si512(_mm512_load_si512(line), _mm512_srlv_epi64(_mm512_set1_epi64(-1), shift));
+		return line[0] + _mm512_reduce_add_epi64(_mm512_popcnt_epi64(masked));
+#else
+		const uint64_t word = offset / 64;
+		uint64_t rank = line[0];
+		// A fixed number of iterations avoids mispredictions, and all words are in the same line
+		for (uint64_t w = 0; w < WORDS_PER_LINE - 2; w++) rank += __builtin_popcountll(line[1 + w]) & -(w < word);
+		return rank + __builtin_popcountll(line[1 + word] & ((1ULL << offset % 64) - 1));
+#endif
+	}
+#ifdef SUX_POPCOUNT_AVX512
+#pragma GCC diagnostic pop
+#endif
+
+  public:
+	using StaticRank<InterleavedRank<AT>>::rank;
+
+	/** Ranks a batch of positions.
+	 *
+	 * The result is the same as calling rank(size_t) on each position, but the lines
+	 * for several positions are prefetched in advance, so that cache misses of different
+	 * queries overlap.
+	 *
+	 * @param pos an array of `n` positions.
+	 * @param out an array of `n` elements that will be filled with the ranks.
+	 * @param n the number of positions.
+	 */
+	void rank(const size_t *pos, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			for (size_t j = base; j < base + b; j++) __builtin_prefetch(lines + pos[j] / BITS_PER_LINE * WORDS_PER_LINE);
+			for (size_t j = base; j < base + b; j++) out[j] = rankKernel(pos[j]);
+		}
+	}
+
+	/** Returns an estimate of the size in bits of this structure, including the bit vector. */
+	size_t bitCount() const { return data.bitCount() - sizeof(data) * 8 + sizeof(*this) * 8; }
+
+	/** Returns the size in bits of the underlying bit vector. */
+	size_t size() const { return num_bits; }
+};
+
+} // namespace sux::bits
@@ -0,0 +1,88 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/common.hpp"
+#include <cstdint>
+
+namespace sux::bits {
+
+using namespace std;
+using namespace sux;
+
+/** A cursor enumerating the positions of the ones of a bit vector.
+ *
+ * Starting from a given position, each call to next() returns the position of the
+ * following one, scanning the bit vector a word at a time. Rank/select structures
+ * return instances positioned on the one of given rank, so that enumerating a range
+ * of ones costs a single selection instead of one selection per one.
+ *
+ * The iterator does not check the end of the bit vector: it must not be asked for
+ * more ones than those following its starting position.
+ */
+
+class OnesIterator {
+	const uint64_t *bits;
+	uint64_t word_index, window;
+
+  public:
+	/** Creates a new iterator.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param pos a position smaller than the length of the bit vector; the first
+	 * call to next() will return the position of the first one at or after `pos`.
+	 */
+	OnesIterator(const uint64_t *const bits, const uint64_t pos) : bits(bits), word_index(pos / 64), window(bits[pos / 64] & -1ULL << pos % 64) {}
+
+	/** Returns the position of the next one. */
+	uint64_t next() {
+		while (window == 0) window = bits[++word_index];
+		const uint64_t pos = word_index * 64 + rho(window);
+		window = clear_rho(window);
+		return pos;
+	}
+
+	/** Fills an array with the positions of the next ones.
+	 *
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of positions to enumerate.
+	 */
+	void next(uint64_t *out, const size_t n) {
+		for (uint64_t *const end = out + n; out < end;) {
+			while (window == 0) window = bits[++word_index];
+			const uint64_t base = word_index * 64;
+			do {
+				*out++ = base + rho(window);
+				window = clear_rho(window);
+			} while (window != 0 && out < end);
+		}
+	}
+};
+
+} // namespace sux::bits
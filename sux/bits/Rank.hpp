@@ -81,4 +81,29 @@ class Rank {
 	virtual std::size_t size() const = 0;
 };
 
+/** A static version of the Rank interface, based on the curiously recurring template pattern.
+ *
+ * A class `D` extending `StaticRank<D>` implements ranking in a non-virtual method
+ * `uint64_t rankKernel(std::size_t)`, which must be accessible to this class. All ranking methods
+ * are then bound statically (and can be inlined) when called on a reference to `D` or to `StaticRank<D>`,
+ * for example in generic code such as
+ *
+ *     template <typename D> uint64_t count(StaticRank<D> &r, ...) { ... r.rank(pos) ... }
+ *
+ * whereas Rank provides an adapter with dynamic binding.
+ *
+ * @tparam D the class implementing this interface.
+ */
+
+template <typename D> class StaticRank : public Rank {
+  public:
+	uint64_t rank(std::size_t pos) final { return static_cast<D *>(this)->rankKernel(pos); }
+
+	uint64_t rank(std::size_t from, std::size_t to) { return rank(to) - rank(from); }
+
+	uint64_t rankZero(std::size_t pos) final { return pos - rank(pos); }
+
+	uint64_t rankZero(std::size_t from, std::size_t to) { return rankZero(to) - rankZero(from); }
+};
+
 } // namespace sux
@@ -28,11 +28,14 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
 #include "../util/Vector.hpp"
 #include "Rank.hpp"
 
 #include <cstdint>
+#include <vector>
 
 namespace sux::bits {
 
@@ -52,13 +55,22 @@ using namespace sux;
  * @tparam AT a type of memory allocation out of sux::util::AllocType.
  */
 
-template <util::AllocType AT = util::AllocType::MALLOC> class Rank9 : public Rank {
+template <util::AllocType AT = util::AllocType::MALLOC> class Rank9 : public StaticRank<Rank9<AT>> {
   protected:
-	const size_t num_bits;
+	size_t num_bits;
 	size_t num_ones;
 	const uint64_t *bits;
 	util::Vector<uint64_t, AT> counts;
 
+	// Words per task of a parallel construction (a multiple of 8)
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+
+	// Number of queries whose memory accesses are overlapped by the batch versions of rank() and select()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	/** Creates an empty instance, for subclasses that fill the counts incrementally. */
+	Rank9() : num_bits(0), num_ones(0), bits(nullptr) {}
+
   public:
 	/** Creates a new instance using a given bit vector.
 	 *
@@ -72,38 +84,99 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9 : public Ran
 	 *
 	 * @param bits a bit vector of 64-bit words.
 	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
 	 */
 
-	Rank9(const uint64_t *const bits, const uint64_t num_bits) : num_bits(num_bits), bits(bits) {
+	Rank9(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : num_bits(num_bits), bits(bits) {
 		const uint64_t num_words = (num_bits + 63) / 64;
 		const uint64_t num_counts = ((num_bits + 64 * 8 - 1) / (64 * 8)) * 2;
 
 		// Init rank structure
 		counts.size(num_counts + 2);
 
-		num_ones = 0;
-		uint64_t pos = 0;
-		for (uint64_t i = 0; i < num_words; i += 8, pos += 2) {
-			counts[pos] = num_ones;
-			num_ones += __builtin_popcountll(bits[i]);
-			for (int j = 1; j < 8; j++) {
-				counts[pos + 1] |= (num_ones - counts[pos]) << 9 * (j - 1);
-				if (i + j < num_words) num_ones += __builtin_popcountll(bits[i + j]);
-			}
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		if (num_threads <= 1 || num_chunks <= 1) {
+			num_ones = rank9_counts(bits, num_words, &counts);
+		} else {
+			// Count the ones of each chunk, compute prefix sums, and then fill the counts of each chunk independently
+			std::vector<uint64_t> chunk_ones(num_chunks + 1);
+			work_stealing(num_chunks, num_threads, [&](const uint64_t c, size_t) { chunk_ones[c + 1] = popcount(bits + c * CHUNK_WORDS, min(CHUNK_WORDS, num_words - c * CHUNK_WORDS)); });
+			for (uint64_t c = 0; c < num_chunks; c++) chunk_ones[c + 1] += chunk_ones[c];
+			work_stealing(num_chunks, num_threads, [&](const uint64_t c, size_t) {
+				rank9_counts(bits + c * CHUNK_WORDS, min(CHUNK_WORDS, num_words - c * CHUNK_WORDS), &counts + c * CHUNK_WORDS / 4, chunk_ones[c]);
+			});
+			num_ones = chunk_ones[num_chunks];
 		}
-
 		counts[num_counts] = num_ones;
 
 		assert(num_ones <= num_bits);
 	}
 
-	uint64_t rank(const size_t k) {
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	Rank9(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, num_bits, num_ones);
+		is >> counts;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	Rank9(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, num_bits, num_ones);
+		counts = util::Vector<uint64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const Rank9<AT> &rank9) {
+		util::write_words(os, rank9.num_bits, rank9.num_ones);
+		return os << rank9.counts;
+	}
+
+  private:
+	friend StaticRank<Rank9<AT>>;
+
+	SUX_MULTIVERSION uint64_t rankKernel(const size_t k) {
 		const uint64_t word = k / 64;
 		const uint64_t block = word / 4 & ~1;
 		const int offset = word % 8 - 1;
 		return counts[block] + (counts[block + 1] >> (offset + (offset >> (sizeof offset * 8 - 4) & 0x8)) * 9 & 0x1FF) + __builtin_popcountll(bits[word] & ((1ULL << k % 64) - 1));
 	}
 
+  public:
+	using StaticRank<Rank9<AT>>::rank;
+
+	/** Ranks a batch of positions.
+	 *
+	 * The result is the same as calling rank(size_t) on each position, but the counts
+	 * and the words of the bit vector for several positions are prefetched in advance,
+	 * so that cache misses of different queries overlap.
+	 *
+	 * @param pos an array of `n` positions.
+	 * @param out an array of `n` elements that will be filled with the ranks.
+	 * @param n the number of positions.
+	 */
+	void rank(const size_t *pos, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			for (size_t j = base; j < base + b; j++) {
+				__builtin_prefetch(&counts + (pos[j] / 64 / 4 & ~1));
+				__builtin_prefetch(bits + pos[j] / 64);
+			}
+			for (size_t j = base; j < base + b; j++) out[j] = rankKernel(pos[j]);
+		}
+	}
+
 	/** Returns an estimate of the size in bits of this structure. */
 	size_t bitCount() const { return counts.bitCount() - sizeof(counts) * 8 + sizeof(*this) * 8; }
 
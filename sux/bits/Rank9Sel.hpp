@@ -29,6 +29,7 @@
 #pragma once
 
 #include "../support/common.hpp"
+#include "OnesIterator.hpp"
 #include "Rank9.hpp"
 #include "Select.hpp"
 #include <cstdint>
@@ -47,8 +48,8 @@ namespace sux::bits {
  * argument size(), you must have at least one additional
  * free bit at the end of the provided bit vector.
  */
-template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public Rank9<AT>, public Select {
-  private:
+template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public Rank9<AT>, public StaticSelect<Rank9Sel<AT>> {
+  protected:
 	static const int log2_ones_per_inventory = 9;
 	static const int ones_per_inventory = 1 << log2_ones_per_inventory;
 	static const uint64_t inventory_mask = ones_per_inventory - 1;
@@ -56,24 +57,140 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 	util::Vector<uint64_t, AT> inventory, subinventory;
 	uint64_t inventory_size;
 
-  public:
-	/** Creates a new instance using a given bit vector.
+	// Inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	// The Rank9 subcounts of a block made of zeros, that is, 64k in the 9-bit field of the k-th word
+	static constexpr uint64_t ZEROS_SUBCOUNTS = UINT64_C(64) << 0 | UINT64_C(128) << 9 | UINT64_C(192) << 18 | UINT64_C(256) << 27 | UINT64_C(320) << 36 | UINT64_C(384) << 45 | UINT64_C(448) << 54;
+
+	/* The methods below implement Select9 on ones or, if ZERO is true, on zeros, in which case
+	 * the counts of Rank9 are complemented with respect to the number of bits and the words of
+	 * the bit vector are complemented. Zeros after the end of the bit vector are never selected. */
+
+	// Returns the number of ones (zeros) before a Rank9 block
+	template <bool ZERO> uint64_t count(const uint64_t block) const { return ZERO ? block * 64 * 8 - this->counts[block * 2] : this->counts[block * 2]; }
+
+	// Returns the 9-bit subcounts of ones (zeros) of a Rank9 block
+	template <bool ZERO> uint64_t subcounts(const uint64_t block) const { return ZERO ? ZEROS_SUBCOUNTS - this->counts[block * 2 + 1] : this->counts[block * 2 + 1]; }
+
+	// Returns a word of the bit vector (of its complement)
+	template <bool ZERO> uint64_t word(const uint64_t w) const { return ZERO ? ~this->bits[w] : this->bits[w]; }
+
+	/** Returns the position of a one (zero), given a block containing it or preceding it.
 	 *
-	 * Note that this constructor only stores a reference
-	 * to the provided bit vector. Should the content of the
-	 * bit vector change, the results will be unpredictable.
+	 * @param rank the rank of a one (zero).
+	 * @param block a Rank9 block not following the one of rank `rank`; it will be
+	 * updated to the block containing it.
+	 */
+	template <bool ZERO> uint64_t locate(const uint64_t rank, uint64_t &block) const {
+		while (count<ZERO>(block + 1) <= rank) block++;
+		assert(count<ZERO>(block) <= rank);
+
+		uint64_t w = block * 8, residual = rank - count<ZERO>(block);
+		for (uint64_t c; (c = nu(word<ZERO>(w))) <= residual; w++) residual -= c;
+		return w * 64 + select64(word<ZERO>(w), residual);
+	}
+
+	/** Fills the subinventory of an inventory entry.
 	 *
-	 * **Warning**: if you plan an calling rank(size_t) with
-	 * argument size(), you must have at least one additional
-	 * free bit at the end of the provided bit vector.
+	 * Depending on the span of the entry, either the positions of all its ones are
+	 * recorded (using 64, 32 or 16 bits), or the counts of Rank9 that it spans are
+	 * copied as 16-bit offsets; in the first case, ones are enumerated a word at a time.
 	 *
-	 * @param bits a bit vector of 64-bit words.
-	 * @param num_bits the length (in bits) of the bit vector.
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param subinventory the subinventory.
+	 * @param num the number of ones (zeros).
+	 * @param index an inventory index.
+	 * @param first_bit the value of `inventory[index]`.
+	 * @param next_bit the value of `inventory[index + 1]`.
 	 */
+	template <bool ZERO> void fillSubinventory(util::Vector<uint64_t, AT> &subinventory, const uint64_t num, const uint64_t index, const uint64_t first_bit, const uint64_t next_bit) {
+		uint64_t *const s = &subinventory[(first_bit / 64) / 4];
+		const uint64_t span = (next_bit / 64) / 4 - (first_bit / 64) / 4;
+
+		if (span < 128) {
+			const uint64_t counts_at_start = count<ZERO>((first_bit / 64) / 8);
+			const uint64_t block_span = (next_bit / 64) / 8 - (first_bit / 64) / 8;
+			const uint64_t block_left = (first_bit / 64) / 8;
+			uint16_t *const s16 = (uint16_t *)s;
+
+			if (span >= 16) {
+				assert(((block_span + 8) & -8LL) + 8 <= span * 4);
+
+				uint64_t k;
+				for (k = 0; k < block_span; k++) {
+					assert(s16[k + 8] == 0);
+					s16[k + 8] = count<ZERO>(block_left + k + 1) - counts_at_start;
+				}
+
+				for (; k < ((block_span + 8) & -8LL); k++) {
+					assert(s16[k + 8] == 0);
+					s16[k + 8] = 0xFFFFU;
+				}
 
-	Rank9Sel(const uint64_t *const bits, const uint64_t num_bits) : Rank9<AT>(bits, num_bits) {
-		const uint64_t num_words = (num_bits + 63) / 64;
-		inventory_size = (this->num_ones + ones_per_inventory - 1) / ones_per_inventory;
+				assert(block_span / 8 <= 8);
+
+				for (k = 0; k < block_span / 8; k++) {
+					assert(s16[k] == 0);
+					s16[k] = count<ZERO>(block_left + (k + 1) * 8) - counts_at_start;
+				}
+
+				for (; k < 8; k++) {
+					assert(s16[k] == 0);
+					s16[k] = 0xFFFFU;
+				}
+			} else if (span >= 2) {
+				assert(((block_span + 8) & -8LL) <= span * 4);
+
+				uint64_t k;
+				for (k = 0; k < block_span; k++) {
+					assert(s16[k] == 0);
+					s16[k] = count<ZERO>(block_left + k + 1) - counts_at_start;
+				}
+
+				for (; k < ((block_span + 8) & -8LL); k++) {
+					assert(s16[k] == 0);
+					s16[k] = 0xFFFFU;
+				}
+			}
+			return;
+		}
+
+		// Enumerate the ones (zeros) of the entry, a word at a time
+		const uint64_t ones = min(uint64_t(ones_per_inventory), num - (index << log2_ones_per_inventory));
+		uint64_t curr = first_bit / 64, w = word<ZERO>(curr) & -1ULL << first_bit % 64;
+		for (uint64_t k = 0; k < ones; k++) {
+			while (w == 0) w = word<ZERO>(++curr);
+			const uint64_t pos = curr * 64 + __builtin_ctzll(w);
+			w &= w - 1;
+
+			if (span >= 512) {
+				assert(s[k] == 0);
+				s[k] = pos;
+			} else if (span >= 256) {
+				assert(((uint32_t *)s)[k] == 0);
+				assert(pos - first_bit < (1ULL << 32));
+				((uint32_t *)s)[k] = pos - first_bit;
+			} else {
+				assert(((uint16_t *)s)[k] == 0);
+				assert(pos - first_bit < (1 << 16));
+				((uint16_t *)s)[k] = pos - first_bit;
+			}
+		}
+	}
+
+	/** Builds an inventory and its subinventory.
+	 *
+	 * @param inventory the inventory.
+	 * @param subinventory the subinventory.
+	 * @param num the number of ones (zeros).
+	 * @param num_threads the number of threads.
+	 * @return the size of the inventory.
+	 */
+	template <bool ZERO> uint64_t buildInventory(util::Vector<uint64_t, AT> &inventory, util::Vector<uint64_t, AT> &subinventory, const uint64_t num, const size_t num_threads) {
+		const uint64_t num_bits = this->num_bits, num_words = (num_bits + 63) / 64;
+		const uint64_t inventory_size = (num + ones_per_inventory - 1) / ones_per_inventory;
 
 #ifdef DEBUG
 		printf("Number of ones per inventory item: %d\n", ones_per_inventory);
@@ -83,119 +200,138 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 		inventory.size(inventory_size + 1);
 		subinventory.size((num_words + 3) / 4);
 
-		uint64_t d = 0;
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++)
-				if (bits[i] & 1ULL << j) {
-					if ((d & inventory_mask) == 0) {
-						inventory[d >> log2_ones_per_inventory] = i * 64 + j;
-						assert(this->counts[(i / 8) * 2] <= d);
-						assert(this->counts[(i / 8) * 2 + 2] > d);
-					}
-
-					d++;
-				}
-
-		assert(this->num_ones == d);
 		inventory[inventory_size] = ((num_words + 3) & ~3ULL) * 64;
 
+		// Inventory entries are located using the counts of Rank9, and then within a block a word at a time;
+		// as soon as an entry is known, the subinventory of the previous one can be filled. Each task
+		// handles a range of entries, locating also the first entry of the next range without storing it.
+		const uint64_t num_blocks = (num_bits + 64 * 8 - 1) / (64 * 8);
+		work_stealing((inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t c, size_t) {
+			const uint64_t from = c * CHUNK_INVENTORY, to = min(from + CHUNK_INVENTORY, inventory_size);
+
+			// Find the last block starting with at most from * ones_per_inventory ones
+			uint64_t lo = 0, hi = num_blocks;
+			while (hi - lo > 1) {
+				const uint64_t mid = (lo + hi) / 2;
+				if (count<ZERO>(mid) <= from << log2_ones_per_inventory)
+					lo = mid;
+				else
+					hi = mid;
+			}
+
+			uint64_t block = lo, curr = inventory[from] = locate<ZERO>(from << log2_ones_per_inventory, block);
+			for (uint64_t index = from + 1; index <= to; index++) {
+				const uint64_t next = index < inventory_size ? locate<ZERO>(index << log2_ones_per_inventory, block) : inventory[inventory_size];
+				if (index < to) inventory[index] = next;
+				fillSubinventory<ZERO>(subinventory, num, index - 1, curr, next);
+				curr = next;
+			}
+		});
+
 #ifdef DEBUG
 		printf("Inventory size: %" PRId64 "\n", inventory_size);
-		printf("Inventory entries filled: %" PRId64 "\n", d / ones_per_inventory + 1);
-		// printf("First inventories: %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 "\n", inventory[0],
-		// inventory[1], inventory[2],
-		//       inventory[3]);
 #endif
+		return inventory_size;
+	}
 
-		d = 0;
-		int state;
-		uint64_t *s, first_bit, index, span, block_span, block_left, counts_at_start;
-
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++)
-				if (bits[i] & 1ULL << j) {
-					if ((d & inventory_mask) == 0) {
-						first_bit = i * 64 + j;
-						index = d >> log2_ones_per_inventory;
-						assert(inventory[index] == first_bit);
-						s = &subinventory[(inventory[index] / 64) / 4];
-						span = (inventory[index + 1] / 64) / 4 - (inventory[index] / 64) / 4;
-						state = -1;
-						counts_at_start = this->counts[((inventory[index] / 64) / 8) * 2];
-						block_span = (inventory[index + 1] / 64) / 8 - (inventory[index] / 64) / 8;
-						block_left = (inventory[index] / 64) / 8;
-
-						if (span >= 512)
-							state = 0;
-						else if (span >= 256)
-							state = 1;
-						else if (span >= 128)
-							state = 2;
-						else if (span >= 16) {
-							assert(((block_span + 8) & -8LL) + 8 <= span * 4);
-
-							uint64_t k;
-							for (k = 0; k < block_span; k++) {
-								assert(((uint16_t *)s)[k + 8] == 0);
-								((uint16_t *)s)[k + 8] = this->counts[(block_left + k + 1) * 2] - counts_at_start;
-							}
-
-							for (; k < ((block_span + 8) & -8LL); k++) {
-								assert(((uint16_t *)s)[k + 8] == 0);
-								((uint16_t *)s)[k + 8] = 0xFFFFU;
-							}
-
-							assert(block_span / 8 <= 8);
-
-							for (k = 0; k < block_span / 8; k++) {
-								assert(((uint16_t *)s)[k] == 0);
-								((uint16_t *)s)[k] = this->counts[(block_left + (k + 1) * 8) * 2] - counts_at_start;
-							}
-
-							for (; k < 8; k++) {
-								assert(((uint16_t *)s)[k] == 0);
-								((uint16_t *)s)[k] = 0xFFFFU;
-							}
-						} else if (span >= 2) {
-							assert(((block_span + 8) & -8LL) <= span * 4);
-
-							uint64_t k;
-							for (k = 0; k < block_span; k++) {
-								assert(((uint16_t *)s)[k] == 0);
-								((uint16_t *)s)[k] = this->counts[(block_left + k + 1) * 2] - counts_at_start;
-							}
-
-							for (; k < ((block_span + 8) & -8LL); k++) {
-								assert(((uint16_t *)s)[k] == 0);
-								((uint16_t *)s)[k] = 0xFFFFU;
-							}
-						}
-					}
-
-					switch (state) {
-					case 0:
-						assert(s[d & inventory_mask] == 0);
-						s[d & inventory_mask] = i * 64 + j;
-						break;
-					case 1:
-						assert(((uint32_t *)s)[d & inventory_mask] == 0);
-						assert(i * 64 + j - first_bit < (1ULL << 32));
-						((uint32_t *)s)[d & inventory_mask] = i * 64 + j - first_bit;
-						break;
-					case 2:
-						assert(((uint16_t *)s)[d & inventory_mask] == 0);
-						assert(i * 64 + j - first_bit < (1 << 16));
-						((uint16_t *)s)[d & inventory_mask] = i * 64 + j - first_bit;
-						break;
-					}
-
-					d++;
-				}
+	/** Creates an empty instance, for subclasses that fill the inventories incrementally. */
+	Rank9Sel() : inventory_size(0) {}
+
+  public:
+	/** Creates a new instance using a given bit vector.
+	 *
+	 * Note that this constructor only stores a reference
+	 * to the provided bit vector. Should the content of the
+	 * bit vector change, the results will be unpredictable.
+	 *
+	 * **Warning**: if you plan an calling rank(size_t) with
+	 * argument size(), you must have at least one additional
+	 * free bit at the end of the provided bit vector.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
+	 */
+
+	Rank9Sel(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : Rank9<AT>(bits, num_bits, num_threads) {
+		inventory_size = buildInventory<false>(inventory, subinventory, this->num_ones, num_threads);
 	}
 
-	size_t select(const uint64_t rank) {
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	Rank9Sel(const uint64_t *const bits, std::istream &is) : Rank9<AT>(bits, is) {
+		util::read_words(is, inventory_size);
+		is >> inventory >> subinventory;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	Rank9Sel(const uint64_t *const bits, const char *&image) : Rank9<AT>(bits, image) {
+		util::view_words(image, inventory_size);
+		inventory = util::Vector<uint64_t, AT>::view(image);
+		subinventory = util::Vector<uint64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const Rank9Sel<AT> &rank9sel) {
+		os << static_cast<const Rank9<AT> &>(rank9sel);
+		util::write_words(os, rank9sel.inventory_size);
+		return os << rank9sel.inventory << rank9sel.subinventory;
+	}
+
+  private:
+	friend StaticSelect<Rank9Sel<AT>>;
+
+	// Prefetches, in two rounds, the inventory entries and then the subinventory entries, counts and blocks used by a batch of selections.
+	void prefetch(const uint64_t *rank, const size_t n) const {
+		for (size_t j = 0; j < n; j++) __builtin_prefetch(&inventory + (rank[j] >> log2_ones_per_inventory));
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t inventory_index_left = rank[j] >> log2_ones_per_inventory;
+			const uint64_t block_left = inventory[inventory_index_left] / 64;
+			const uint64_t span = (inventory[inventory_index_left + 1] / 64) / 4 - block_left / 4;
+			const uint64_t *const s = &subinventory[block_left / 4];
+
+			if (span < 128) {
+				__builtin_prefetch(&this->counts + ((block_left & ~7) / 4 & ~1));
+				if (span < 2) {
+					// The whole Rank9 block is known
+					__builtin_prefetch(this->bits + (block_left & ~7));
+					__builtin_prefetch(this->bits + (block_left & ~7) + 7);
+				} else
+					__builtin_prefetch(s);
+			} else if (span < 256)
+				__builtin_prefetch((uint16_t *)s + rank[j] % ones_per_inventory);
+			else if (span < 512)
+				__builtin_prefetch((uint32_t *)s + rank[j] % ones_per_inventory);
+			else
+				__builtin_prefetch(s + rank[j] % ones_per_inventory);
+		}
+	}
+
+	SUX_MULTIVERSION size_t selectKernel(const uint64_t rank) { return select9<false>(inventory, subinventory, rank); }
+
+  protected:
+	/** Selects a one (a zero) using an inventory and its subinventory.
+	 *
+	 * @param inventory the inventory.
+	 * @param subinventory the subinventory.
+	 * @param rank the rank of a one (zero).
+	 * @return the position of the one (zero) of given rank.
+	 */
+	template <bool ZERO> SUX_MULTIVERSION size_t select9(const util::Vector<uint64_t, AT> &inventory, const util::Vector<uint64_t, AT> &subinventory, const uint64_t rank) const {
 		const uint64_t inventory_index_left = rank >> log2_ones_per_inventory;
-		assert(inventory_index_left <= inventory_size);
+		assert(inventory_index_left < inventory.size());
 
 		const uint64_t inventory_left = inventory[inventory_index_left];
 		const uint64_t block_right = inventory[inventory_index_left + 1] / 64;
@@ -211,15 +347,15 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 		if (span < 2) {
 			block_left &= ~7;
 			count_left = block_left / 4 & ~1;
-			assert(rank < this->counts[count_left + 2]);
-			rank_in_block = rank - this->counts[count_left];
+			assert(rank < count<ZERO>(count_left / 2 + 1));
+			rank_in_block = rank - count<ZERO>(count_left / 2);
 #ifdef DEBUG
 			printf("Single span; rank_in_block: %" PRId64 " block_left: %" PRId64 "\n", rank_in_block, block_left);
 #endif
 		} else if (span < 16) {
 			block_left &= ~7;
 			count_left = block_left / 4 & ~1;
-			const uint64_t rank_in_superblock = rank - this->counts[count_left];
+			const uint64_t rank_in_superblock = rank - count<ZERO>(count_left / 2);
 			const uint64_t rank_in_superblock_step_16 = rank_in_superblock * ONES_STEP_16;
 
 			const uint64_t first = s[0], second = s[1];
@@ -232,16 +368,16 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 
 			block_left += where * 4;
 			count_left += where;
-			rank_in_block = rank - this->counts[count_left];
+			rank_in_block = rank - count<ZERO>(count_left / 2);
 			assert(rank_in_block < 512);
 #ifdef DEBUG
 			printf("Found where (1): %d rank_in_block: %" PRId64 " block_left: %" PRId64 "\n", where, rank_in_block, block_left);
-			printf("superthis->counts: %016" PRIx64 " %016" PRIx64 "\n", s[0], s[1]);
+			printf("supercounts: %016" PRIx64 " %016" PRIx64 "\n", s[0], s[1]);
 #endif
 		} else if (span < 128) {
 			block_left &= ~7;
 			count_left = block_left / 4 & ~1;
-			const uint64_t rank_in_superblock = rank - this->counts[count_left];
+			const uint64_t rank_in_superblock = rank - count<ZERO>(count_left / 2);
 			const uint64_t rank_in_superblock_step_16 = rank_in_superblock * ONES_STEP_16;
 
 			const uint64_t first = s[0], second = s[1];
@@ -252,7 +388,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 
 			block_left += where1 * 4;
 			count_left += where1;
-			rank_in_block = rank - this->counts[count_left];
+			rank_in_block = rank - count<ZERO>(count_left / 2);
 			assert(rank_in_block < 512);
 
 #ifdef DEBUG
@@ -267,7 +403,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 		}
 
 		const uint64_t rank_in_block_step_9 = rank_in_block * ONES_STEP_9;
-		const uint64_t subcounts = this->counts[count_left + 1];
+		const uint64_t subcounts = this->subcounts<ZERO>(count_left / 2);
 		const uint64_t offset_in_block = (ULEQ_STEP_9(subcounts, rank_in_block_step_9) * ONES_STEP_9 >> 54 & 0x7);
 
 		const uint64_t word = block_left + offset_in_block;
@@ -285,9 +421,49 @@ template <util::AllocType AT = util::AllocType::MALLOC> class Rank9Sel : public
 		assert(rank_in_word < 64);
 
 #ifdef DEBUG
-		printf("Returning %" PRId64 "\n", word * UINT64_C(64) + select64(this->bits[word], rank_in_word));
+		printf("Returning %" PRId64 "\n", word * UINT64_C(64) + select64(this->word<ZERO>(word), rank_in_word));
 #endif
-		return word * UINT64_C(64) + select64(this->bits[word], rank_in_word);
+		return word * UINT64_C(64) + select64(this->word<ZERO>(word), rank_in_word);
+	}
+
+  public:
+	using StaticSelect<Rank9Sel<AT>>::select;
+
+	/** Selects a batch of ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but the inventories,
+	 * the counts and, when possible, the words of the bit vector for several ranks are
+	 * prefetched in advance, so that cache misses of different queries overlap.
+	 *
+	 * @param rank an array of `n` ranks.
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of ranks.
+	 */
+	void select(const uint64_t *rank, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += this->PREFETCH_BATCH) {
+			const size_t b = std::min(this->PREFETCH_BATCH, n - base);
+			prefetch(rank + base, b);
+			for (size_t j = base; j < base + b; j++) out[j] = selectKernel(rank[j]);
+		}
+	}
+
+	/** Returns an iterator on the ones of the bit vector.
+	 *
+	 * @param rank the rank of the first one returned by the iterator, which must be smaller than the number of ones.
+	 */
+	OnesIterator iterator(const uint64_t rank) { return OnesIterator(this->bits, selectKernel(rank)); }
+
+	/** Selects a range of consecutive ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but only the first
+	 * rank is selected: the following ones are found by scanning the bit vector.
+	 *
+	 * @param from the first rank.
+	 * @param to the last rank (exclusive).
+	 * @param out an array of `to - from` elements that will be filled with the positions.
+	 */
+	void selectRange(const uint64_t from, const uint64_t to, uint64_t *out) {
+		if (from < to) iterator(from).next(out, to - from);
 	}
 
 	size_t bitCount() const {
@@ -0,0 +1,118 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/common.hpp"
+#include "Rank9Sel.hpp"
+#include "SelectZero.hpp"
+#include <cstdint>
+
+namespace sux::bits {
+
+/** A Rank9Sel that supports also selection of zeros.
+ *
+ * Zeros are selected by a second Select9 inventory, which is built against the
+ * same Rank9 counts, complemented on the fly: no additional counts are needed,
+ * so selection of zeros costs 25%-37.5% additional space, depending on density.
+ *
+ * The constructors of this class only store a reference
+ * to a provided bit vector. Should the content of the
+ * bit vector change, the results will be unpredictable.
+ *
+ * **Warning**: if you plan an calling rank(size_t) with
+ * argument size(), you must have at least one additional
+ * free bit at the end of the provided bit vector.
+ */
+template <util::AllocType AT = util::AllocType::MALLOC> class Rank9SelZero : public Rank9Sel<AT>, public StaticSelectZero<Rank9SelZero<AT>> {
+  private:
+	util::Vector<uint64_t, AT> inventory_zero, subinventory_zero;
+	uint64_t inventory_zero_size;
+
+  public:
+	/** Creates a new instance using a given bit vector.
+	 *
+	 * Note that this constructor only stores a reference
+	 * to the provided bit vector. Should the content of the
+	 * bit vector change, the results will be unpredictable.
+	 *
+	 * **Warning**: if you plan an calling rank(size_t) with
+	 * argument size(), you must have at least one additional
+	 * free bit at the end of the provided bit vector.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
+	 */
+	Rank9SelZero(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : Rank9Sel<AT>(bits, num_bits, num_threads) {
+		inventory_zero_size = this->template buildInventory<true>(inventory_zero, subinventory_zero, num_bits - this->num_ones, num_threads);
+	}
+
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	Rank9SelZero(const uint64_t *const bits, std::istream &is) : Rank9Sel<AT>(bits, is) {
+		util::read_words(is, inventory_zero_size);
+		is >> inventory_zero >> subinventory_zero;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	Rank9SelZero(const uint64_t *const bits, const char *&image) : Rank9Sel<AT>(bits, image) {
+		util::view_words(image, inventory_zero_size);
+		inventory_zero = util::Vector<uint64_t, AT>::view(image);
+		subinventory_zero = util::Vector<uint64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const Rank9SelZero<AT> &rank9selzero) {
+		os << static_cast<const Rank9Sel<AT> &>(rank9selzero);
+		util::write_words(os, rank9selzero.inventory_zero_size);
+		return os << rank9selzero.inventory_zero << rank9selzero.subinventory_zero;
+	}
+
+  private:
+	friend StaticSelectZero<Rank9SelZero<AT>>;
+
+	SUX_MULTIVERSION size_t selectZeroKernel(const uint64_t rank) { return this->template select9<true>(inventory_zero, subinventory_zero, rank); }
+
+  public:
+	size_t bitCount() const { return Rank9Sel<AT>::bitCount() - sizeof(Rank9Sel<AT>) * 8 + inventory_zero.bitCount() - sizeof(inventory_zero) * 8 + subinventory_zero.bitCount() - sizeof(subinventory_zero) * 8 + sizeof(*this) * 8; }
+};
+
+} // namespace sux::bits
@@ -0,0 +1,147 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/common.hpp"
+#include "EliasFano.hpp"
+#include "Rank.hpp"
+#include "Select.hpp"
+#include "SelectZero.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace sux::bits {
+
+using namespace std;
+
+/** A compressed rank/select structure for bit vectors made of long runs.
+ *
+ * The bit vector is represented by its maximal runs of ones: for each run, the
+ * structure stores its starting position, the number of ones before it and the number
+ * of zeros before it, each sequence in an instance of EliasFano. The space used is thus
+ * proportional to the number of runs rather than to the length of the bit vector, and
+ * on clustered bit vectors it is much smaller than that of the bit vector itself.
+ *
+ * Each operation requires an Elias&ndash;Fano ranking and one or two Elias&ndash;Fano
+ * selections. Differently from Rank9Sel, the bit vector is read only at construction time.
+ *
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+
+template <util::AllocType AT = util::AllocType::MALLOC>
+class RunLengthRankSel : public StaticRank<RunLengthRankSel<AT>>, public StaticSelect<RunLengthRankSel<AT>>, public StaticSelectZero<RunLengthRankSel<AT>> {
+  private:
+	uint64_t num_bits, num_ones;
+	// The positions of the first bit of each run, and the number of ones and of zeros before each run
+	EliasFano<AT> starts, ones_before, zeros_before;
+
+	// Scans a bit vector, filling the run starts and the number of ones and zeros before each run
+	static uint64_t runs(const uint64_t *const bits, const uint64_t num_bits, vector<uint64_t> &starts, vector<uint64_t> &ones_before, vector<uint64_t> &zeros_before) {
+		const uint64_t num_words = (num_bits + 63) / 64;
+		uint64_t ones = 0, run_start = 0, prev = 0;
+		bool in_run = false;
+		for (uint64_t w = 0; w < num_words; w++) {
+			const uint64_t word = w < num_words - 1 || num_bits % 64 == 0 ? bits[w] : bits[w] & ((1ULL << num_bits % 64) - 1);
+			// Transitions between runs
+			for (uint64_t t = word ^ (word << 1 | prev); t != 0; t &= t - 1) {
+				const uint64_t pos = w * 64 + __builtin_ctzll(t);
+				if (!in_run) {
+					starts.push_back(pos);
+					ones_before.push_back(ones);
+					zeros_before.push_back(pos - ones);
+					run_start = pos;
+				} else
+					ones += pos - run_start;
+				in_run = !in_run;
+			}
+			prev = word >> 63;
+		}
+		if (in_run) ones += num_bits - run_start;
+		return ones;
+	}
+
+  public:
+	/** Creates a new instance using a given bit vector.
+	 *
+	 * Note that the bit vector is read only at construction time.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 */
+	RunLengthRankSel(const uint64_t *const bits, const uint64_t num_bits) : num_bits(num_bits) {
+		vector<uint64_t> s, o, z;
+		num_ones = runs(bits, num_bits, s, o, z);
+		// A final sentinel makes it possible to retrieve the length of the last run
+		o.push_back(num_ones);
+		starts = EliasFano<AT>(s, num_bits);
+		ones_before = EliasFano<AT>(o, num_ones + 1);
+		zeros_before = EliasFano<AT>(z, num_bits - num_ones + 1);
+	}
+
+	/** Returns the number of runs of ones. */
+	uint64_t numRuns() { return starts.rank(num_bits); }
+
+  private:
+	friend StaticRank<RunLengthRankSel<AT>>;
+	friend StaticSelect<RunLengthRankSel<AT>>;
+	friend StaticSelectZero<RunLengthRankSel<AT>>;
+
+	uint64_t rankKernel(const size_t pos) {
+		if (pos >= num_bits) return num_ones;
+		// Runs starting before pos
+		const uint64_t j = starts.rank(pos);
+		if (j == 0) return 0;
+		uint64_t next;
+		const uint64_t ones = ones_before.select(j - 1, &next);
+		return ones + min(pos - starts.select(j - 1), next - ones);
+	}
+
+	size_t selectKernel(const uint64_t rank) {
+		// The run containing the one of given rank is the last one with at most rank ones before it
+		const uint64_t j = ones_before.rank(rank + 1) - 1;
+		return starts.select(j) + rank - ones_before.select(j);
+	}
+
+	size_t selectZeroKernel(const uint64_t rank) {
+		// The zero of given rank follows all runs with at most rank zeros before them
+		return rank + ones_before.select(zeros_before.rank(rank + 1));
+	}
+
+  public:
+	/** Returns an estimate of the size in bits of this structure. */
+	size_t bitCount() const {
+		return starts.bitCount() - sizeof(starts) * 8 + ones_before.bitCount() - sizeof(ones_before) * 8 + zeros_before.bitCount() - sizeof(zeros_before) * 8 + sizeof(*this) * 8;
+	}
+
+	/** Returns the size in bits of the underlying bit vector. */
+	size_t size() const { return num_bits; }
+};
+
+} // namespace sux::bits
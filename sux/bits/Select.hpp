@@ -49,4 +49,18 @@ class Select {
 	virtual std::size_t select(uint64_t rank) = 0;
 };
 
+/** A static version of the Select interface, based on the curiously recurring template pattern.
+ *
+ * A class `D` extending `StaticSelect<D>` implements selection in a non-virtual method
+ * `std::size_t selectKernel(uint64_t)`, which must be accessible to this class;
+ * see StaticRank for details.
+ *
+ * @tparam D the class implementing this interface.
+ */
+
+template <typename D> class StaticSelect : public Select {
+  public:
+	std::size_t select(uint64_t rank) final { return static_cast<D *>(this)->selectKernel(rank); }
+};
+
 } // namespace sux
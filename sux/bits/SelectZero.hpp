@@ -53,4 +53,18 @@ class SelectZero {
 	virtual std::size_t selectZero(uint64_t rank) = 0;
 };
 
+/** A static version of the SelectZero interface, based on the curiously recurring template pattern.
+ *
+ * A class `D` extending `StaticSelectZero<D>` implements selection in a non-virtual method
+ * `std::size_t selectZeroKernel(uint64_t)`, which must be accessible to this class;
+ * see StaticRank for details.
+ *
+ * @tparam D the class implementing this interface.
+ */
+
+template <typename D> class StaticSelectZero : public SelectZero {
+  public:
+	std::size_t selectZero(uint64_t rank) final { return static_cast<D *>(this)->selectZeroKernel(rank); }
+};
+
 } // namespace sux
@@ -28,15 +28,21 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
 #include "../util/Vector.hpp"
+#include "OnesIterator.hpp"
 #include "Select.hpp"
 #include <cstdint>
+#include <vector>
 
 namespace sux::bits {
 
 using namespace std;
 
+template <util::AllocType AT> class SimpleSelectTuner;
+
 /** A simple Select implementation based on a two-level inventory, a spill list and broadword bit search.
  *
  * This implementation uses around 13.75% additional space on evenly distributed bit arrays, and,
@@ -50,8 +56,10 @@ using namespace std;
  * @tparam AT a type of memory allocation out of sux::util::AllocType.
  */
 
-template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : public Select {
+template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : public StaticSelect<SimpleSelect<AT>> {
   private:
+	template <util::AllocType> friend class SimpleSelectTuner;
+
 	static const int max_ones_per_inventory = 8192;
 
 	const uint64_t *bits;
@@ -60,7 +68,76 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 	int log2_ones_per_inventory, log2_ones_per_sub16, log2_ones_per_sub64, log2_longwords_per_subinventory, ones_per_inventory, ones_per_sub16, ones_per_sub64, longwords_per_subinventory,
 		longwords_per_inventory, ones_per_inventory_mask, ones_per_sub16_mask, ones_per_sub64_mask;
 
-	uint64_t num_words, inventory_size, exact_spill_size, num_ones;
+	uint64_t num_words, inventory_size, exact_spill_size = 0, num_ones;
+
+	// Number of queries whose memory accesses are overlapped by the batch version of select()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	// Words and inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	// Prefetches, in two rounds, the inventory entries and then the words of the bit vector (or the spilled positions) used by a batch of selections.
+	void prefetch(const uint64_t *rank, const size_t n) const {
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t inventory_index = rank[j] >> log2_ones_per_inventory;
+			__builtin_prefetch(&inventory + (inventory_index << log2_longwords_per_subinventory) + inventory_index);
+		}
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t inventory_index = rank[j] >> log2_ones_per_inventory;
+			const int64_t *inventory_start = &inventory + (inventory_index << log2_longwords_per_subinventory) + inventory_index;
+			const int64_t inventory_rank = *inventory_start;
+			const int subrank = rank[j] & ones_per_inventory_mask;
+			if (subrank == 0) continue;
+
+			if (inventory_rank >= 0)
+				__builtin_prefetch(bits + (inventory_rank + ((uint16_t *)(inventory_start + 1))[subrank >> log2_ones_per_sub16]) / 64);
+			else if (ones_per_sub64 == 1)
+				__builtin_prefetch(inventory_start + 1 + subrank);
+			else
+				__builtin_prefetch(&exact_spill + *(inventory_start + 1) + subrank);
+		}
+	}
+
+	/** Fills the subinventory of an inventory entry.
+	 *
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param inventory_index an inventory index.
+	 */
+	void fillSubinventory(const uint64_t inventory_index) {
+		[[maybe_unused]] const int64_t *const end_of_inventory = &inventory + inventory_size * longwords_per_inventory + 1;
+		const int64_t inventory_rank = inventory[inventory_index * longwords_per_inventory];
+		const uint64_t start = inventory_rank & ~(1ULL << 63);
+		const uint64_t span = (inventory[(inventory_index + 1) * longwords_per_inventory] & ~(1ULL << 63)) - start;
+		int64_t *const p64 = &inventory[inventory_index * longwords_per_inventory + 1];
+
+		// The ones of the entry, and the number of ones before the word containing the first one
+		const uint64_t first = inventory_index << log2_ones_per_inventory, last = min(num_ones, first + ones_per_inventory);
+		const uint64_t rank = first - nu(bits[start / 64] & ((1ULL << start % 64) - 1));
+
+		if (span < (1 << 16)) {
+			uint16_t *const p16 = (uint16_t *)p64;
+			select_every<false>(bits, start / 64, rank, first, last, log2_ones_per_sub16, [&](const uint64_t r, const uint64_t pos) {
+				assert(pos - start <= (1 << 16));
+				assert(((r - first) >> log2_ones_per_sub16) < (uint64_t)longwords_per_subinventory * 4);
+				assert(p16 + ((r - first) >> log2_ones_per_sub16) < (uint16_t *)end_of_inventory);
+				p16[(r - first) >> log2_ones_per_sub16] = pos - start;
+			});
+		} else if (ones_per_sub64 == 1) {
+			select_every<false>(bits, start / 64, rank, first, last, 0, [&](const uint64_t r, const uint64_t pos) {
+				assert(p64 + (r - first) < end_of_inventory);
+				p64[r - first] = pos;
+			});
+		} else {
+			assert(inventory_rank < 0);
+			const uint64_t spilled = p64[0];
+			select_every<false>(bits, start / 64, rank, first, last, 0, [&](const uint64_t r, const uint64_t pos) {
+				assert(spilled + (r - first) < exact_spill_size);
+				exact_spill[spilled + (r - first)] = pos;
+			});
+		}
+	}
 
   public:
 	SimpleSelect() {}
@@ -71,13 +148,17 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 	 * @param num_bits the length (in bits) of the bit vector.
 	 * @param max_log2_longwords_per_subinventory the number of words per subinventory:
 	 * a larger value yields a faster map that uses more space; typical values are between 0 and 3.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
 	 */
-	SimpleSelect(const uint64_t *const bits, const uint64_t num_bits, const int max_log2_longwords_per_subinventory) : bits(bits) {
+	SimpleSelect(const uint64_t *const bits, const uint64_t num_bits, const int max_log2_longwords_per_subinventory, const size_t num_threads = 1) : bits(bits) {
 		num_words = (num_bits + 63) / 64;
 
-		// Init rank/select structure
-		uint64_t c = 0;
-		for (uint64_t i = 0; i < num_words; i++) c += __builtin_popcountll(bits[i]);
+		// Init rank/select structure, counting the ones of each chunk of words
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		std::vector<uint64_t> chunk_ones(num_chunks + 1);
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) { chunk_ones[k + 1] = popcount(bits + k * CHUNK_WORDS, min(CHUNK_WORDS, num_words - k * CHUNK_WORDS)); });
+		for (uint64_t k = 0; k < num_chunks; k++) chunk_ones[k + 1] += chunk_ones[k];
+		const uint64_t c = chunk_ones[num_chunks];
 		num_ones = c;
 
 		assert(c <= num_bits);
@@ -108,21 +189,13 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 #endif
 
 		inventory.size(inventory_size * longwords_per_inventory + 1);
-		const int64_t *end_of_inventory = &inventory + inventory_size * longwords_per_inventory + 1;
 
-		uint64_t d = 0;
+		// First phase: we build an inventory for each one out of ones_per_inventory, locating ones a word at a time.
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			select_every<false>(bits, k * CHUNK_WORDS, chunk_ones[k], chunk_ones[k], chunk_ones[k + 1], log2_ones_per_inventory,
+				[&](const uint64_t rank, const uint64_t pos) { inventory[(rank >> log2_ones_per_inventory) * longwords_per_inventory] = pos; });
+		});
 
-		// First phase: we build an inventory for each one out of ones_per_inventory.
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (bits[i] & 1ULL << j) {
-					if ((d & ones_per_inventory_mask) == 0) inventory[(d >> log2_ones_per_inventory) * longwords_per_inventory] = i * 64 + j;
-					d++;
-				}
-			}
-
-		assert(c == d);
 		inventory[inventory_size * longwords_per_inventory] = num_bits;
 
 #ifdef DEBUG
@@ -130,84 +203,32 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 #endif
 
 		if (ones_per_inventory > 1) {
-			d = 0;
-			int ones;
-			uint64_t spilled = 0, exact = 0, start, span, inventory_index;
-
-			for (uint64_t i = 0; i < num_words; i++)
-				// We estimate the subinventory and exact spill size
-				for (int j = 0; j < 64; j++) {
-					if (i * 64 + j >= num_bits) break;
-					if (bits[i] & 1ULL << j) {
-						if ((d & ones_per_inventory_mask) == 0) {
-							inventory_index = d >> log2_ones_per_inventory;
-							start = inventory[inventory_index * longwords_per_inventory];
-							span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
-							ones = min(c - d, (uint64_t)ones_per_inventory);
-
-							assert(start + span == num_bits || ones == ones_per_inventory);
-
-							// We accumulate space for exact pointers ONLY if necessary.
-							if (span >= (1 << 16)) {
-								exact += ones;
-								if (ones_per_sub64 > 1) spilled += ones;
-							}
-						}
-						d++;
-					}
+			uint64_t spilled = 0;
+
+			// Second phase: spans are known from the inventory alone, so we can mark entries whose ones are spilled
+			// (as they span too many bits for 16-bit offsets) and assign them space in the exact spill list.
+			for (uint64_t inventory_index = 0; inventory_index < inventory_size; inventory_index++) {
+				const uint64_t start = inventory[inventory_index * longwords_per_inventory];
+				const uint64_t span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
+				if (span >= (1 << 16) && ones_per_sub64 > 1) {
+					inventory[inventory_index * longwords_per_inventory] |= 1ULL << 63;
+					inventory[inventory_index * longwords_per_inventory + 1] = spilled;
+					spilled += min(c - (inventory_index << log2_ones_per_inventory), (uint64_t)ones_per_inventory);
 				}
+			}
 
 #ifdef DEBUG
-			printf("Spilled entries: %" PRId64 " exact: %" PRId64 "\n", spilled, exact);
+			printf("Spilled entries: %" PRId64 "\n", spilled);
 #endif
 
 			exact_spill_size = spilled;
 			exact_spill.size(exact_spill_size);
 
-			uint16_t *p16;
-			int64_t *p64;
-			int offset;
-			spilled = 0;
-			d = 0;
-
-			for (uint64_t i = 0; i < num_words; i++)
-				for (int j = 0; j < 64; j++) {
-					if (i * 64 + j >= num_bits) break;
-					if (bits[i] & 1ULL << j) {
-						if ((d & ones_per_inventory_mask) == 0) {
-							inventory_index = d >> log2_ones_per_inventory;
-							start = inventory[inventory_index * longwords_per_inventory];
-							span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
-							p64 = &inventory[inventory_index * longwords_per_inventory + 1];
-							p16 = (uint16_t *)p64;
-							offset = 0;
-						}
-
-						if (span < (1 << 16)) {
-							assert(i * 64 + j - start <= (1 << 16));
-							if ((d & ones_per_sub16_mask) == 0) {
-								assert(offset < longwords_per_subinventory * 4);
-								assert(p16 + offset < (uint16_t *)end_of_inventory);
-								p16[offset++] = i * 64 + j - start;
-							}
-						} else {
-							if (ones_per_sub64 == 1) {
-								assert(p64 + offset < end_of_inventory);
-								p64[offset++] = i * 64 + j;
-							} else {
-								assert(p64 < end_of_inventory);
-								if ((d & ones_per_inventory_mask) == 0) {
-									inventory[inventory_index * longwords_per_inventory] |= 1ULL << 63;
-									p64[0] = spilled;
-								}
-								assert(spilled < exact_spill_size);
-								exact_spill[spilled++] = i * 64 + j;
-							}
-						}
-
-						d++;
-					}
-				}
+			// Third phase: subinventories are disjoint, so they are filled in parallel.
+			work_stealing((inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t k, size_t) {
+				for (uint64_t inventory_index = k * CHUNK_INVENTORY; inventory_index < min((k + 1) * CHUNK_INVENTORY, inventory_size); inventory_index++)
+					fillSubinventory(inventory_index);
+			});
 		}
 #ifdef DEBUG
 		// printf("First inventories: %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 "\n", inventory[0],
@@ -223,7 +244,46 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 #endif
 	}
 
-	size_t select(const uint64_t rank) {
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	SimpleSelect(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, log2_ones_per_inventory, log2_ones_per_sub16, log2_ones_per_sub64, log2_longwords_per_subinventory, ones_per_inventory, ones_per_sub16, ones_per_sub64,
+			longwords_per_subinventory, longwords_per_inventory, ones_per_inventory_mask, ones_per_sub16_mask, ones_per_sub64_mask, num_words, inventory_size, exact_spill_size, num_ones);
+		is >> inventory >> exact_spill;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	SimpleSelect(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, log2_ones_per_inventory, log2_ones_per_sub16, log2_ones_per_sub64, log2_longwords_per_subinventory, ones_per_inventory, ones_per_sub16, ones_per_sub64,
+			longwords_per_subinventory, longwords_per_inventory, ones_per_inventory_mask, ones_per_sub16_mask, ones_per_sub64_mask, num_words, inventory_size, exact_spill_size, num_ones);
+		inventory = util::Vector<int64_t, AT>::view(image);
+		exact_spill = util::Vector<uint64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const SimpleSelect<AT> &simple) {
+		util::write_words(os, simple.log2_ones_per_inventory, simple.log2_ones_per_sub16, simple.log2_ones_per_sub64, simple.log2_longwords_per_subinventory, simple.ones_per_inventory,
+			simple.ones_per_sub16, simple.ones_per_sub64, simple.longwords_per_subinventory, simple.longwords_per_inventory, simple.ones_per_inventory_mask, simple.ones_per_sub16_mask,
+			simple.ones_per_sub64_mask, simple.num_words, simple.inventory_size, simple.exact_spill_size, simple.num_ones);
+		return os << simple.inventory << simple.exact_spill;
+	}
+
+  private:
+	friend StaticSelect<SimpleSelect<AT>>;
+
+	SUX_MULTIVERSION size_t selectKernel(const uint64_t rank) {
 #ifdef DEBUG
 		printf("Selecting %" PRId64 "\n...", rank);
 #endif
@@ -275,6 +335,46 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelect : pub
 		return word_index * 64 + select64(word, residual);
 	}
 
+  public:
+	using StaticSelect<SimpleSelect<AT>>::select;
+
+	/** Selects a batch of ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but the inventories
+	 * and the words of the bit vector for several ranks are prefetched in advance, so
+	 * that cache misses of different queries overlap.
+	 *
+	 * @param rank an array of `n` ranks.
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of ranks.
+	 */
+	void select(const uint64_t *rank, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			prefetch(rank + base, b);
+			for (size_t j = base; j < base + b; j++) out[j] = selectKernel(rank[j]);
+		}
+	}
+
+	/** Returns an iterator on the ones of the bit vector.
+	 *
+	 * @param rank the rank of the first one returned by the iterator, which must be smaller than the number of ones.
+	 */
+	OnesIterator iterator(const uint64_t rank) { return OnesIterator(bits, selectKernel(rank)); }
+
+	/** Selects a range of consecutive ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but only the first
+	 * rank is selected: the following ones are found by scanning the bit vector.
+	 *
+	 * @param from the first rank.
+	 * @param to the last rank (exclusive).
+	 * @param out an array of `to - from` elements that will be filled with the positions.
+	 */
+	void selectRange(const uint64_t from, const uint64_t to, uint64_t *out) {
+		if (from < to) iterator(from).next(out, to - from);
+	}
+
 	/** Returns an estimate of the size (in bits) of this structure. */
 	size_t bitCount() const { return inventory.bitCount() - sizeof(inventory) * 8 + exact_spill.bitCount() - sizeof(exact_spill) * 8 + sizeof(*this) * 8; }
 };
@@ -0,0 +1,335 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
+#include "../support/common.hpp"
+#include "../util/Vector.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sux::bits {
+
+using namespace std;
+using namespace sux;
+
+/** A combination of SimpleSelectHalf and SimpleSelectZeroHalf sharing a bit vector.
+ *
+ * The inventories of ones and of zeros are built in a single scan of the bit vector,
+ * and are stored in a single array in which the entries for the ones and for the zeros
+ * of the same index are adjacent: on a bit vector with approximately the same number of
+ * zeros and ones, such as the upper bits of EliasFano, selecting a one and a zero at nearby
+ * positions accesses nearby memory. The entries of the longer inventory that have no
+ * counterpart in the shorter one follow the interleaved pairs, so the space used is the
+ * same as that of a SimpleSelectHalf and a SimpleSelectZeroHalf.
+ *
+ * The constructors of this class only store a reference
+ * to a provided bit vector. Should the content of the
+ * bit vector change, the results will be unpredictable.
+ *
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+
+template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectBoth {
+  private:
+	static const int log2_ones_per_inventory = 10;
+	static const int ones_per_inventory = 1 << log2_ones_per_inventory;
+	static const int ones_per_inventory_mask = ones_per_inventory - 1;
+	static const int log2_longwords_per_subinventory = 2;
+	static const int longwords_per_subinventory = 1 << log2_longwords_per_subinventory;
+	static const int log2_ones_per_sub64 = log2_ones_per_inventory - log2_longwords_per_subinventory;
+	static const int ones_per_sub64 = 1 << log2_ones_per_sub64;
+	static const uint64_t ones_per_sub64_mask = ones_per_sub64 - 1;
+	static const int log2_ones_per_sub16 = log2_ones_per_sub64 - 2;
+	static const int ones_per_sub16 = 1 << log2_ones_per_sub16;
+	static const uint64_t ones_per_sub16_mask = ones_per_sub16 - 1;
+	static const int longwords_per_entry = longwords_per_subinventory + 1;
+	// An entry of the inventory of ones followed by an entry of the inventory of zeros
+	static const int longwords_per_pair = 2 * longwords_per_entry;
+
+	const uint64_t *bits;
+	util::Vector<int64_t, AT> inventory;
+
+	uint64_t num_words, inventory_size, inventory_zero_size, num_ones, num_zeros;
+	// Number of interleaved pairs of entries (including the sentinel of the shorter inventory)
+	uint64_t num_pairs;
+
+	// Number of queries whose memory accesses are overlapped by the batch version of select()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	// Words and inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	// Returns the offset of an entry of the inventory of ones (zeros): entries of the longer inventory
+	// without a counterpart in the shorter one follow the interleaved pairs.
+	template <bool ZERO> uint64_t offset(const uint64_t inventory_index) const {
+		return inventory_index < num_pairs ? inventory_index * longwords_per_pair + (ZERO ? longwords_per_entry : 0) : (num_pairs + inventory_index) * longwords_per_entry;
+	}
+
+	// Returns the inventory entry of the one (zero) of given rank
+	template <bool ZERO> const int64_t *entry(const uint64_t rank) const { return &inventory + offset<ZERO>(rank >> log2_ones_per_inventory); }
+
+	// Returns a word of the bit vector (of its complement)
+	template <bool ZERO> uint64_t word(const uint64_t w) const { return ZERO ? ~bits[w] : bits[w]; }
+
+	/** Fills the subinventory of an inventory entry.
+	 *
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param inventory_index an inventory index.
+	 */
+	template <bool ZERO> void fillSubinventory(const uint64_t inventory_index) {
+		int64_t *const inventory_start = &inventory[offset<ZERO>(inventory_index)];
+		const uint64_t start = inventory_start[0];
+		const uint64_t span = inventory[offset<ZERO>(inventory_index + 1)] - start;
+
+		// The ones (zeros) of the entry, and the number of ones (zeros) before the word containing the first one (zero)
+		const uint64_t first = inventory_index << log2_ones_per_inventory, last = min(ZERO ? num_zeros : num_ones, first + ones_per_inventory);
+		const uint64_t rank = first - nu(word<ZERO>(start / 64) & ((1ULL << start % 64) - 1));
+
+		if (span < (1 << 16)) {
+			uint16_t *const p16 = (uint16_t *)(inventory_start + 1);
+			select_every<ZERO>(bits, start / 64, rank, first, last, log2_ones_per_sub16, [&](const uint64_t r, const uint64_t pos) {
+				assert(pos - start <= (1 << 16));
+				p16[(r - first) >> log2_ones_per_sub16] = pos - start;
+			});
+		} else {
+			select_every<ZERO>(bits, start / 64, rank, first, last, log2_ones_per_sub64, [&](const uint64_t r, const uint64_t pos) {
+				assert(((r - first) >> log2_ones_per_sub64) < longwords_per_subinventory);
+				inventory_start[1 + ((r - first) >> log2_ones_per_sub64)] = pos - start;
+			});
+		}
+	}
+
+	// Marks by negation the entries of the inventory of ones (zeros) whose span is too large for 16-bit offsets
+	template <bool ZERO> void negate(const uint64_t size) {
+		for (uint64_t i = 0; i < size; i++) {
+			int64_t &start = inventory[offset<ZERO>(i)];
+			if (inventory[offset<ZERO>(i + 1)] - start >= (1 << 16)) start = -start - 1;
+		}
+	}
+
+	// Prefetches, in two rounds, the inventory entries and then the words of the bit vector used by a batch of selections.
+	void prefetch(const uint64_t *rank, const size_t n) const {
+		for (size_t j = 0; j < n; j++) __builtin_prefetch(entry<false>(rank[j]));
+		for (size_t j = 0; j < n; j++) {
+			const int64_t *inventory_start = entry<false>(rank[j]);
+			const int64_t inventory_rank = *inventory_start;
+			const int subrank = rank[j] & ones_per_inventory_mask;
+
+			if (inventory_rank >= 0)
+				__builtin_prefetch(bits + (inventory_rank + ((uint16_t *)(inventory_start + 1))[subrank >> log2_ones_per_sub16]) / 64);
+			else
+				__builtin_prefetch(bits + (-inventory_rank - 1 + *(inventory_start + 1 + (subrank >> log2_ones_per_sub64))) / 64);
+		}
+	}
+
+	template <bool ZERO> SUX_MULTIVERSION uint64_t selectKernel(const uint64_t rank) const {
+		assert(rank < (ZERO ? num_zeros : num_ones));
+
+		const int64_t *inventory_start = entry<ZERO>(rank);
+		const int64_t inventory_rank = *inventory_start;
+		const int subrank = rank & ones_per_inventory_mask;
+
+		uint64_t start;
+		int residual;
+
+		if (inventory_rank >= 0) {
+			start = inventory_rank + ((uint16_t *)(inventory_start + 1))[subrank >> log2_ones_per_sub16];
+			residual = subrank & ones_per_sub16_mask;
+		} else {
+			assert((subrank >> log2_ones_per_sub64) < longwords_per_subinventory);
+			start = -inventory_rank - 1 + *(inventory_start + 1 + (subrank >> log2_ones_per_sub64));
+			residual = subrank & ones_per_sub64_mask;
+		}
+
+		if (residual == 0) return start;
+
+		uint64_t word_index = start / 64;
+		uint64_t w = word<ZERO>(word_index) & -1ULL << start % 64;
+
+		for (;;) {
+			const int bit_count = __builtin_popcountll(w);
+			if (residual < bit_count) break;
+			w = word<ZERO>(++word_index);
+			residual -= bit_count;
+		}
+
+		return word_index * 64 + select64(w, residual);
+	}
+
+	// Returns the position of the one (zero) following a given one (zero)
+	template <bool ZERO> uint64_t next(const uint64_t s) const {
+		uint64_t curr = s / 64;
+		uint64_t window = word<ZERO>(curr) & -1ULL << s % 64;
+		window &= window - 1;
+
+		while (window == 0) window = word<ZERO>(++curr);
+		return curr * 64 + __builtin_ctzll(window);
+	}
+
+  public:
+	SimpleSelectBoth() {}
+
+	/** Creates a new instance using a given bit vector.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
+	 */
+	SimpleSelectBoth(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : bits(bits) {
+		num_words = (num_bits + 63) / 64;
+
+		// Init rank/select structure, counting the ones of each chunk of words
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		std::vector<uint64_t> chunk_ones(num_chunks + 1);
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) { chunk_ones[k + 1] = popcount(bits + k * CHUNK_WORDS, min(CHUNK_WORDS, num_words - k * CHUNK_WORDS)); });
+		for (uint64_t k = 0; k < num_chunks; k++) chunk_ones[k + 1] += chunk_ones[k];
+		num_ones = chunk_ones[num_chunks];
+		num_zeros = num_bits - num_ones;
+
+		assert(num_ones <= num_bits);
+
+		inventory_size = (num_ones + ones_per_inventory - 1) / ones_per_inventory;
+		inventory_zero_size = (num_zeros + ones_per_inventory - 1) / ones_per_inventory;
+		num_pairs = min(inventory_size, inventory_zero_size) + 1;
+
+#ifdef DEBUG
+		printf("Number of bits: %" PRId64 " Number of ones: %" PRId64 " (%.2f%%)\n", num_bits, num_ones, (num_ones * 100.0) / num_bits);
+#endif
+
+		inventory.size((inventory_size + 1 + inventory_zero_size + 1) * longwords_per_entry);
+
+		// First phase: in a single scan, we build an inventory entry for each one and each zero out of
+		// ones_per_inventory, locating them a word at a time; the zeros past the end of the bit vector are never located.
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			uint64_t ones = chunk_ones[k], zeros = k * CHUNK_WORDS * 64 - ones;
+			uint64_t target_one = (ones + ones_per_inventory - 1) & -ones_per_inventory, target_zero = (zeros + ones_per_inventory - 1) & -ones_per_inventory;
+			for (uint64_t w = k * CHUNK_WORDS; w < min((k + 1) * CHUNK_WORDS, num_words); w++) {
+				const uint64_t c = nu(bits[w]);
+				for (; target_one < ones + c; target_one += ones_per_inventory) inventory[offset<false>(target_one >> log2_ones_per_inventory)] = w * 64 + select64(bits[w], target_one - ones);
+				for (; target_zero < min(zeros + 64 - c, num_zeros); target_zero += ones_per_inventory)
+					inventory[offset<true>(target_zero >> log2_ones_per_inventory)] = w * 64 + select64(~bits[w], target_zero - zeros);
+				ones += c;
+				zeros += 64 - c;
+			}
+		});
+
+		// The entries past the end of each inventory act as sentinels
+		inventory[offset<false>(inventory_size)] = num_bits;
+		inventory[offset<true>(inventory_zero_size)] = num_bits;
+
+		// Second phase: subinventories are disjoint, so they are filled in parallel, each task handling adjacent entries of both inventories.
+		const uint64_t max_inventory_size = max(inventory_size, inventory_zero_size);
+		work_stealing((max_inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t k, size_t) {
+			for (uint64_t p = k * CHUNK_INVENTORY; p < min((k + 1) * CHUNK_INVENTORY, max_inventory_size); p++) {
+				if (p < inventory_size) fillSubinventory<false>(p);
+				if (p < inventory_zero_size) fillSubinventory<true>(p);
+			}
+		});
+
+		// Third phase: entries whose ones (zeros) span too many bits for 16-bit offsets are marked by negating them.
+		negate<false>(inventory_size);
+		negate<true>(inventory_zero_size);
+	}
+
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	SimpleSelectBoth(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, num_words, inventory_size, inventory_zero_size, num_ones, num_zeros);
+		num_pairs = min(inventory_size, inventory_zero_size) + 1;
+		is >> inventory;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	SimpleSelectBoth(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, num_words, inventory_size, inventory_zero_size, num_ones, num_zeros);
+		num_pairs = min(inventory_size, inventory_zero_size) + 1;
+		inventory = util::Vector<int64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const SimpleSelectBoth<AT> &simple) {
+		util::write_words(os, simple.num_words, simple.inventory_size, simple.inventory_zero_size, simple.num_ones, simple.num_zeros);
+		return os << simple.inventory;
+	}
+
+	uint64_t select(const uint64_t rank) { return selectKernel<false>(rank); }
+
+	uint64_t selectZero(const uint64_t rank) { return selectKernel<true>(rank); }
+
+	/** Selects a batch of ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but the inventories
+	 * and the words of the bit vector for several ranks are prefetched in advance, so
+	 * that cache misses of different queries overlap.
+	 *
+	 * @param rank an array of `n` ranks.
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of ranks.
+	 */
+	void select(const uint64_t *rank, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			prefetch(rank + base, b);
+			for (size_t j = base; j < base + b; j++) out[j] = selectKernel<false>(rank[j]);
+		}
+	}
+
+	uint64_t select(const uint64_t rank, uint64_t *const next) {
+		const uint64_t s = select(rank);
+		*next = this->next<false>(s);
+		return s;
+	}
+
+	uint64_t selectZero(const uint64_t rank, uint64_t *const next) {
+		const uint64_t s = selectZero(rank);
+		*next = this->next<true>(s);
+		return s;
+	}
+
+	/** Returns an estimate of the size (in bits) of this structure. */
+	size_t bitCount() const { return inventory.bitCount() - sizeof(inventory) * 8 + sizeof(*this) * 8; };
+};
+
+} // namespace sux::bits
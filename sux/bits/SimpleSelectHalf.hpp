@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
 #include "../util/Vector.hpp"
 #include "Select.hpp"
 #include <cstdint>
+#include <vector>
 
 namespace sux::bits {
 
@@ -70,6 +73,63 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectHalf {
 
 	uint64_t num_words, inventory_size, num_ones;
 
+	// Number of queries whose memory accesses are overlapped by the batch version of select()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	// Prefetches, in two rounds, the inventory entries and then the words of the bit vector used by a batch of selections.
+	void prefetch(const uint64_t *rank, const size_t n) const {
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t inventory_index = rank[j] >> log2_ones_per_inventory;
+			__builtin_prefetch(&inventory + (inventory_index << log2_longwords_per_subinventory) + inventory_index);
+		}
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t inventory_index = rank[j] >> log2_ones_per_inventory;
+			const int64_t *inventory_start = &inventory + (inventory_index << log2_longwords_per_subinventory) + inventory_index;
+			const int64_t inventory_rank = *inventory_start;
+			const int subrank = rank[j] & ones_per_inventory_mask;
+
+			if (inventory_rank >= 0)
+				__builtin_prefetch(bits + (inventory_rank + ((uint16_t *)(inventory_start + 1))[subrank >> log2_ones_per_sub16]) / 64);
+			else
+				__builtin_prefetch(bits + (-inventory_rank - 1 + *(inventory_start + 1 + (subrank >> log2_ones_per_sub64))) / 64);
+		}
+	}
+
+	// Words and inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	/** Fills the subinventory of an inventory entry.
+	 *
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param inventory_index an inventory index.
+	 * @param num the number of ones in the bit vector.
+	 */
+	void fillSubinventory(const uint64_t inventory_index, const uint64_t num) {
+		int64_t *const inventory_start = &inventory[inventory_index * (longwords_per_subinventory + 1)];
+		const uint64_t start = inventory_start[0];
+		const uint64_t span = inventory_start[longwords_per_subinventory + 1] - start;
+
+		// The ones of the entry, and the number of ones before the word containing the first one
+		const uint64_t first = inventory_index << log2_ones_per_inventory, last = min(num, first + ones_per_inventory);
+		const uint64_t rank = first - nu(bits[start / 64] & ((1ULL << start % 64) - 1));
+
+		if (span < (1 << 16)) {
+			uint16_t *const p16 = (uint16_t *)(inventory_start + 1);
+			select_every<false>(bits, start / 64, rank, first, last, log2_ones_per_sub16, [&](const uint64_t r, const uint64_t pos) {
+				assert(pos - start <= (1 << 16));
+				assert(((r - first) >> log2_ones_per_sub16) < longwords_per_subinventory * 4);
+				p16[(r - first) >> log2_ones_per_sub16] = pos - start;
+			});
+		} else {
+			select_every<false>(bits, start / 64, rank, first, last, log2_ones_per_sub64, [&](const uint64_t r, const uint64_t pos) {
+				assert(((r - first) >> log2_ones_per_sub64) < longwords_per_subinventory);
+				inventory_start[1 + ((r - first) >> log2_ones_per_sub64)] = pos - start;
+			});
+		}
+	}
+
   public:
 	SimpleSelectHalf() {}
 
@@ -77,14 +137,18 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectHalf {
 	 *
 	 * @param bits a bit vector of 64-bit words.
 	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
 	 */
 
-	SimpleSelectHalf(const uint64_t *const bits, const uint64_t num_bits) : bits(bits) {
+	SimpleSelectHalf(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : bits(bits) {
 		num_words = (num_bits + 63) / 64;
 
-		// Init rank/select structure
-		uint64_t c = 0;
-		for (uint64_t i = 0; i < num_words; i++) c += __builtin_popcountll(bits[i]);
+		// Init rank/select structure, counting the ones of each chunk of words
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		std::vector<uint64_t> chunk_ones(num_chunks + 1);
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) { chunk_ones[k + 1] = popcount(bits + k * CHUNK_WORDS, min(CHUNK_WORDS, num_words - k * CHUNK_WORDS)); });
+		for (uint64_t k = 0; k < num_chunks; k++) chunk_ones[k + 1] += chunk_ones[k];
+		const uint64_t c = chunk_ones[num_chunks];
 		num_ones = c;
 
 		assert(c <= num_bits);
@@ -99,74 +163,65 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectHalf {
 
 		inventory.size(inventory_size * (longwords_per_subinventory + 1) + 1);
 
-		uint64_t d = 0;
-		const uint64_t mask = ones_per_inventory - 1;
+		// First phase: we build an inventory for each one out of ones_per_inventory, locating ones a word at a time.
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			select_every<false>(bits, k * CHUNK_WORDS, chunk_ones[k], chunk_ones[k], chunk_ones[k + 1], log2_ones_per_inventory,
+				[&](const uint64_t rank, const uint64_t pos) { inventory[(rank >> log2_ones_per_inventory) * (longwords_per_subinventory + 1)] = pos; });
+		});
 
-		// First phase: we build an inventory for each one out of ones_per_inventory.
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (bits[i] & 1ULL << j) {
-					if ((d & mask) == 0) inventory[(d >> log2_ones_per_inventory) * (longwords_per_subinventory + 1)] = i * 64 + j;
-					d++;
-				}
-			}
-
-		assert(c == d);
 		inventory[inventory_size * (longwords_per_subinventory + 1)] = num_bits;
 
 #ifdef DEBUG
 		printf("Inventory entries filled: %" PRId64 "\n", inventory_size + 1);
 #endif
 
-		uint16_t *p16;
-		int64_t *p64;
-
-		d = 0;
-		uint64_t exact = 0, start, span, inventory_index;
-		int offset;
-
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (bits[i] & 1ULL << j) {
-					if ((d & mask) == 0) {
-						inventory_index = (d >> log2_ones_per_inventory) * (longwords_per_subinventory + 1);
-						start = inventory[inventory_index];
-						span = inventory[inventory_index + longwords_per_subinventory + 1] - start;
-						if (span > (1 << 16)) inventory[inventory_index] = -inventory[inventory_index] - 1;
-						offset = 0;
-						p64 = &inventory[inventory_index + 1];
-						p16 = (uint16_t *)p64;
-					}
-
-					if (span < (1 << 16)) {
-						assert(i * 64 + j - start <= (1 << 16));
-						if ((d & ones_per_sub16_mask) == 0) {
-							assert(offset < longwords_per_subinventory * 4);
-							p16[offset++] = i * 64 + j - start;
-						}
-					} else {
-						if ((d & ones_per_sub64_mask) == 0) {
-							assert(offset < longwords_per_subinventory);
-							p64[offset++] = i * 64 + j - start;
-							exact++;
-						}
-					}
-
-					d++;
-				}
-			}
+		// Second phase: subinventories are disjoint, so they are filled in parallel.
+		work_stealing((inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t k, size_t) {
+			for (uint64_t inventory_index = k * CHUNK_INVENTORY; inventory_index < min((k + 1) * CHUNK_INVENTORY, inventory_size); inventory_index++) fillSubinventory(inventory_index, c);
+		});
 
-#ifdef DEBUG
-			// printf("Exact entries: %" PRId64 "\n", exact);
-			// printf("First inventories: %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 "\n", inventory[0],
-			// inventory[1], inventory[2],
-			//       inventory[3]);
-#endif
+		// Third phase: entries whose ones span too many bits for 16-bit offsets are marked by negating them.
+		for (uint64_t inventory_index = 0; inventory_index < inventory_size; inventory_index++) {
+			int64_t *const inventory_start = &inventory[inventory_index * (longwords_per_subinventory + 1)];
+			if (inventory_start[longwords_per_subinventory + 1] - inventory_start[0] >= (1 << 16)) inventory_start[0] = -inventory_start[0] - 1;
+		}
+	}
+
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	SimpleSelectHalf(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, num_words, inventory_size, num_ones);
+		is >> inventory;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	SimpleSelectHalf(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, num_words, inventory_size, num_ones);
+		inventory = util::Vector<int64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const SimpleSelectHalf<AT> &simple) {
+		util::write_words(os, simple.num_words, simple.inventory_size, simple.num_ones);
+		return os << simple.inventory;
 	}
 
-	uint64_t select(const uint64_t rank) {
+	uint64_t select(const uint64_t rank) { return selectKernel(rank); }
+
+  private:
+	SUX_MULTIVERSION uint64_t selectKernel(const uint64_t rank) {
 #ifdef DEBUG
 		printf("Selecting %" PRId64 "\n...", rank);
 #endif
@@ -214,11 +269,30 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectHalf {
 		return word_index * 64 + select64(word, residual);
 	}
 
+  public:
+	/** Selects a batch of ranks.
+	 *
+	 * The result is the same as calling select(uint64_t) on each rank, but the inventories
+	 * and the words of the bit vector for several ranks are prefetched in advance, so
+	 * that cache misses of different queries overlap.
+	 *
+	 * @param rank an array of `n` ranks.
+	 * @param out an array of `n` elements that will be filled with the positions.
+	 * @param n the number of ranks.
+	 */
+	void select(const uint64_t *rank, uint64_t *out, const size_t n) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			prefetch(rank + base, b);
+			for (size_t j = base; j < base + b; j++) out[j] = selectKernel(rank[j]);
+		}
+	}
+
 	uint64_t select(const uint64_t rank, uint64_t *const next) {
 		const uint64_t s = select(rank);
-		int curr = s / 64;
+		uint64_t curr = s / 64;
 
-		uint64_t window = bits[curr] & -1ULL << s;
+		uint64_t window = bits[curr] & -1ULL << s % 64;
 		window &= window - 1;
 
 		while (window == 0) window = bits[++curr];
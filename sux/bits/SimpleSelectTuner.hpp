@@ -0,0 +1,236 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2007-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/Popcount.hpp"
+#include "../support/common.hpp"
+#include "SimpleSelect.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace sux::bits {
+
+using namespace std;
+using namespace sux;
+
+/** Chooses the subinventory size of a SimpleSelect for a given bit vector.
+ *
+ * The size of the subinventories of SimpleSelect (the `max_log2_longwords_per_subinventory`
+ * argument of its constructor) trades space for speed, but the tradeoff depends on the
+ * distribution of the ones. The first-level inventory does not depend on the setting, so
+ * this class builds it, obtaining the exact space occupancy of each candidate setting
+ * (including the spill list used by entries spanning many bits), and then simulates the
+ * subinventories of a sample of entries to estimate the number of cache lines touched
+ * by a selection. Optionally, benchmark() builds each candidate and measures its speed.
+ *
+ * For example,
+ *
+ *     SimpleSelectTuner tuner(bits, num_bits);
+ *     SimpleSelect simple(bits, num_bits, tuner.forSpace(0.15).max_log2_longwords_per_subinventory);
+ *
+ * builds the fastest SimpleSelect using at most 15% additional space, if any.
+ *
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+
+template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectTuner {
+  public:
+	/** The largest candidate value of `max_log2_longwords_per_subinventory`. */
+	static constexpr int MAX_CANDIDATE = 3;
+
+	/** The estimated cost of a setting. */
+	struct Estimate {
+		/** The value of `max_log2_longwords_per_subinventory`. */
+		int max_log2_longwords_per_subinventory;
+		/** Additional bits per bit of the bit vector. */
+		double space;
+		/** Average number of cache lines touched by a selection. */
+		double lines;
+		/** Average number of words of the bit vector scanned by a selection. */
+		double words;
+		/** Nanoseconds per selection, measured by benchmark(); NaN otherwise. */
+		double ns = NAN;
+
+		/** Returns the measured nanoseconds per selection, if available, or the estimated cache lines. */
+		double cost() const { return std::isnan(ns) ? lines : ns; }
+
+		friend std::ostream &operator<<(std::ostream &os, const Estimate &e) {
+			os << "max_log2_longwords_per_subinventory=" << e.max_log2_longwords_per_subinventory << ": " << e.space * 100 << "% space, " << e.lines << " lines/select, " << e.words
+			   << " words/select";
+			if (!std::isnan(e.ns)) os << ", " << e.ns << " ns/select";
+			return os;
+		}
+	};
+
+  private:
+	const uint64_t *bits;
+	uint64_t num_bits, num_ones;
+	int log2_ones_per_inventory;
+	std::vector<Estimate> estimate;
+
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		return z ^ (z >> 31);
+	}
+
+	// The value of log2_longwords_per_subinventory used by SimpleSelect for a candidate setting
+	int log2LongwordsPerSubinventory(const int max_log2_longwords_per_subinventory) const {
+		return min(max_log2_longwords_per_subinventory, max(0, log2_ones_per_inventory - 2));
+	}
+
+  public:
+	/** Creates a new tuner for a given bit vector, and estimates the cost of each candidate setting.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_samples the number of inventory entries to simulate.
+	 */
+	SimpleSelectTuner(const uint64_t *const bits, const uint64_t num_bits, const size_t num_samples = 256) : bits(bits), num_bits(num_bits) {
+		num_ones = popcount(bits, (num_bits + 63) / 64);
+
+		// The same computation of SimpleSelect
+		const uint64_t ones_per_inventory = num_bits == 0 ? 0 : (num_ones * SimpleSelect<AT>::max_ones_per_inventory + num_bits - 1) / num_bits;
+		log2_ones_per_inventory = max(0, lambda_safe(ones_per_inventory));
+		const uint64_t inventory_size = (num_ones + (UINT64_C(1) << log2_ones_per_inventory) - 1) >> log2_ones_per_inventory;
+
+		// The inventory does not depend on the setting, so spans, and thus the ones in the spill list, are exact
+		std::vector<uint64_t> inventory(inventory_size + 1);
+		select_every<false>(bits, 0, 0, 0, num_ones, log2_ones_per_inventory, [&](const uint64_t rank, const uint64_t pos) { inventory[rank >> log2_ones_per_inventory] = pos; });
+		inventory[inventory_size] = num_bits;
+
+		uint64_t spilled_ones = 0;
+		for (uint64_t i = 0; i < inventory_size; i++)
+			if (log2_ones_per_inventory > 0 && inventory[i + 1] - inventory[i] >= (1 << 16)) spilled_ones += min(num_ones - (i << log2_ones_per_inventory), UINT64_C(1) << log2_ones_per_inventory);
+
+		// Sums over the sampled ones, for each candidate, of the cache lines and words touched by a selection
+		std::vector<double> lines(MAX_CANDIDATE + 1), words(MAX_CANDIDATE + 1);
+		uint64_t sampled_ones = 0;
+		std::vector<uint64_t> pos;
+
+		for (size_t s = 0; s < min(uint64_t(num_samples), inventory_size); s++) {
+			// We simulate a random entry (or all entries, if there are few), collecting the positions of its ones
+			const uint64_t i = inventory_size <= num_samples ? s : remap128(mix(s + 1), inventory_size);
+			const uint64_t first = i << log2_ones_per_inventory, last = min(num_ones, first + (UINT64_C(1) << log2_ones_per_inventory));
+			const uint64_t start = inventory[i];
+			pos.clear();
+			select_every<false>(bits, start / 64, first - nu(bits[start / 64] & ((UINT64_C(1) << start % 64) - 1)), first, last, 0, [&](uint64_t, const uint64_t p) { pos.push_back(p); });
+
+			const bool spilled = log2_ones_per_inventory > 0 && inventory[i + 1] - start >= (1 << 16);
+			sampled_ones += pos.size();
+
+			for (int c = 0; c <= MAX_CANDIDATE; c++) {
+				const int log2_ones_per_sub16 = max(0, log2_ones_per_inventory - log2LongwordsPerSubinventory(c) - 2);
+				const uint64_t ones_per_sub16_mask = (UINT64_C(1) << log2_ones_per_sub16) - 1;
+				for (uint64_t j = 0; j < pos.size(); j++) {
+					// The inventory is always accessed; exact hits need nothing else
+					lines[c]++;
+					if (j == 0) continue;
+					if (spilled) {
+						// A spilled or explicit position
+						lines[c]++;
+					} else if (j & ones_per_sub16_mask) {
+						const uint64_t sub_start = pos[j & ~ones_per_sub16_mask];
+						lines[c] += pos[j] / 512 - sub_start / 512 + 1;
+						words[c] += pos[j] / 64 - sub_start / 64 + 1;
+					}
+				}
+			}
+		}
+
+		for (int c = 0; c <= MAX_CANDIDATE; c++) {
+			const int log2_longwords_per_subinventory = log2LongwordsPerSubinventory(c);
+			// Spilled entries use the spill list, unless their subinventory can store all positions
+			const uint64_t spill_words = log2_ones_per_inventory > log2_longwords_per_subinventory ? spilled_ones : 0;
+			const uint64_t inventory_words = inventory_size * ((UINT64_C(1) << log2_longwords_per_subinventory) + 1) + 1;
+			estimate.push_back({c, num_bits == 0 ? 0 : 64.0 * (inventory_words + spill_words) / num_bits, sampled_ones ? lines[c] / sampled_ones : 0, sampled_ones ? words[c] / sampled_ones : 0});
+		}
+	}
+
+	/** Returns the estimates for all candidate settings, by increasing `max_log2_longwords_per_subinventory`. */
+	const std::vector<Estimate> &estimates() const { return estimate; }
+
+	/** Builds a SimpleSelect for each candidate setting and measures its speed on random selections.
+	 *
+	 * After this call, Estimate::cost() returns the measured speed.
+	 *
+	 * @param num_queries the number of selections timed for each candidate.
+	 * @param num_threads the number of threads used for construction.
+	 */
+	void benchmark(const size_t num_queries, const size_t num_threads = 1) {
+		if (num_ones == 0 || num_queries == 0) return;
+		uint64_t u = 0;
+		for (int c = 0; c <= MAX_CANDIDATE; c++) {
+			// Candidates beyond the largest subinventory usable at this density build the same structure
+			if (c > 0 && log2LongwordsPerSubinventory(c) == log2LongwordsPerSubinventory(c - 1)) {
+				estimate[c].ns = estimate[c - 1].ns;
+				continue;
+			}
+
+			SimpleSelect<AT> simple(bits, num_bits, c, num_threads);
+
+			auto begin = chrono::high_resolution_clock::now();
+			for (size_t q = 0; q < num_queries; q++) u ^= simple.select(remap128(mix(q ^ u), num_ones));
+			auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - begin).count();
+			estimate[c].ns = double(elapsed) / num_queries;
+		}
+		const volatile uint64_t __attribute__((unused)) unused = u;
+	}
+
+	/** Returns the fastest setting whose space does not exceed a given bound.
+	 *
+	 * @param max_space the maximum number of additional bits per bit of the bit vector (e.g., 0.15).
+	 * @return the fastest setting within `max_space`, or the most compact setting if none fits.
+	 */
+	Estimate forSpace(const double max_space) const {
+		auto best = min_element(estimate.begin(), estimate.end(), [](const Estimate &a, const Estimate &b) { return a.space < b.space; });
+		for (auto e = estimate.begin(); e != estimate.end(); ++e)
+			if (e->space <= max_space && (best->space > max_space || e->cost() < best->cost())) best = e;
+		return *best;
+	}
+
+	/** Returns the most compact setting whose cost does not exceed a given bound.
+	 *
+	 * @param max_cost the maximum cost, as returned by Estimate::cost(): nanoseconds per selection after
+	 * benchmark(), and cache lines per selection otherwise.
+	 * @return the most compact setting within `max_cost`, or the fastest setting if none fits.
+	 */
+	Estimate forLatency(const double max_cost) const {
+		auto best = min_element(estimate.begin(), estimate.end(), [](const Estimate &a, const Estimate &b) { return a.cost() < b.cost(); });
+		for (auto e = estimate.begin(); e != estimate.end(); ++e)
+			if (e->cost() <= max_cost && (best->cost() > max_cost || e->space < best->space)) best = e;
+		return *best;
+	}
+};
+
+} // namespace sux::bits
@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
 #include "../util/Vector.hpp"
 #include "SelectZero.hpp"
 #include <cstdint>
+#include <vector>
 
 namespace sux::bits {
 using namespace std;
@@ -59,7 +62,52 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 	int log2_zeros_per_inventory, log2_zeros_per_sub16, log2_zeros_per_sub64, log2_longwords_per_subinventory, zeros_per_inventory, zeros_per_sub16, zeros_per_sub64, longwords_per_subinventory,
 		longwords_per_inventory, zeros_per_inventory_mask, zeros_per_sub16_mask, zeros_per_sub64_mask;
 
-	uint64_t num_words, inventory_size, exact_spill_size, num_zeros;
+	uint64_t num_words, inventory_size, exact_spill_size = 0, num_zeros;
+
+	// Words and inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	/** Fills the subinventory of an inventory entry.
+	 *
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param inventory_index an inventory index.
+	 * @param num the number of zeros in the bit vector.
+	 */
+	void fillSubinventory(const uint64_t inventory_index, const uint64_t num) {
+		[[maybe_unused]] const int64_t *const end_of_inventory = &inventory + inventory_size * longwords_per_inventory + 1;
+		const int64_t inventory_rank = inventory[inventory_index * longwords_per_inventory];
+		const uint64_t start = inventory_rank & ~(1ULL << 63);
+		const uint64_t span = (inventory[(inventory_index + 1) * longwords_per_inventory] & ~(1ULL << 63)) - start;
+		int64_t *const p64 = &inventory[inventory_index * longwords_per_inventory + 1];
+
+		// The zeros of the entry, and the number of zeros before the word containing the first zero
+		const uint64_t first = inventory_index << log2_zeros_per_inventory, last = min(num, first + zeros_per_inventory);
+		const uint64_t rank = first - nu(~bits[start / 64] & ((1ULL << start % 64) - 1));
+
+		if (span < (1 << 16)) {
+			uint16_t *const p16 = (uint16_t *)p64;
+			select_every<true>(bits, start / 64, rank, first, last, log2_zeros_per_sub16, [&](const uint64_t r, const uint64_t pos) {
+				assert(pos - start <= (1 << 16));
+				assert(((r - first) >> log2_zeros_per_sub16) < (uint64_t)longwords_per_subinventory * 4);
+				assert(p16 + ((r - first) >> log2_zeros_per_sub16) < (uint16_t *)end_of_inventory);
+				p16[(r - first) >> log2_zeros_per_sub16] = pos - start;
+			});
+		} else if (zeros_per_sub64 == 1) {
+			select_every<true>(bits, start / 64, rank, first, last, 0, [&](const uint64_t r, const uint64_t pos) {
+				assert(p64 + (r - first) < end_of_inventory);
+				p64[r - first] = pos;
+			});
+		} else {
+			assert(inventory_rank < 0);
+			const uint64_t spilled = p64[0];
+			select_every<true>(bits, start / 64, rank, first, last, 0, [&](const uint64_t r, const uint64_t pos) {
+				assert(spilled + (r - first) < exact_spill_size);
+				exact_spill[spilled + (r - first)] = pos;
+			});
+		}
+	}
 
   public:
 	SimpleSelectZero() {}
@@ -70,13 +118,20 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 	 * @param num_bits the length (in bits) of the bit vector.
 	 * @param max_log2_longwords_per_subinventory the number of words per subinventory:
 	 * a larger value yields a faster map that uses more space; typical values are between 0 and 3.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
 	 */
-	SimpleSelectZero(const uint64_t *const bits, const uint64_t num_bits, const int max_log2_longwords_per_subinventory) : bits(bits) {
+	SimpleSelectZero(const uint64_t *const bits, const uint64_t num_bits, const int max_log2_longwords_per_subinventory, const size_t num_threads = 1) : bits(bits) {
 		num_words = (num_bits + 63) / 64;
 
-		// Init rank/select structure
-		uint64_t c = 0;
-		for (uint64_t i = 0; i < num_words; i++) c += __builtin_popcountll(~bits[i]);
+		// Init rank/select structure, counting the zeros of each chunk of words
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		std::vector<uint64_t> chunk_zeros(num_chunks + 1);
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			const uint64_t words = min(CHUNK_WORDS, num_words - k * CHUNK_WORDS);
+			chunk_zeros[k + 1] = words * 64 - popcount(bits + k * CHUNK_WORDS, words);
+		});
+		for (uint64_t k = 0; k < num_chunks; k++) chunk_zeros[k + 1] += chunk_zeros[k];
+		uint64_t c = chunk_zeros[num_chunks];
 		num_zeros = c;
 
 		if (num_bits % 64 != 0) c -= 64 - num_bits % 64;
@@ -105,21 +160,14 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 #endif
 
 		inventory.size(inventory_size * longwords_per_inventory + 1);
-		const int64_t *end_of_inventory = &inventory + inventory_size * longwords_per_inventory + 1;
 
-		uint64_t d = 0;
+		// First phase: we build an inventory for each zero out of zeros_per_inventory, locating zeros a word at a time;
+		// the zeros past the end of the bit vector are never located, as they follow all other zeros.
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			select_every<true>(bits, k * CHUNK_WORDS, chunk_zeros[k], chunk_zeros[k], min(chunk_zeros[k + 1], c), log2_zeros_per_inventory,
+				[&](const uint64_t rank, const uint64_t pos) { inventory[(rank >> log2_zeros_per_inventory) * longwords_per_inventory] = pos; });
+		});
 
-		// First phase: we build an inventory for each one out of zeros_per_inventory.
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (~bits[i] & 1ULL << j) {
-					if ((d & zeros_per_inventory_mask) == 0) inventory[(d >> log2_zeros_per_inventory) * longwords_per_inventory] = i * 64 + j;
-					d++;
-				}
-			}
-
-		assert(c == d);
 		inventory[inventory_size * longwords_per_inventory] = num_bits;
 
 #ifdef DEBUG
@@ -127,84 +175,32 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 #endif
 
 		if (zeros_per_inventory > 1) {
-			d = 0;
-			int zeros;
-			uint64_t spilled = 0, exact = 0, start, span, inventory_index;
-
-			for (uint64_t i = 0; i < num_words; i++)
-				// We estimate the subinventory and exact spill size
-				for (int j = 0; j < 64; j++) {
-					if (i * 64 + j >= num_bits) break;
-					if (~bits[i] & 1ULL << j) {
-						if ((d & zeros_per_inventory_mask) == 0) {
-							inventory_index = d >> log2_zeros_per_inventory;
-							start = inventory[inventory_index * longwords_per_inventory];
-							span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
-							zeros = min(c - d, (uint64_t)zeros_per_inventory);
-
-							assert(start + span == num_bits || zeros == zeros_per_inventory);
-
-							// We accumulate space for exact pointers ONLY if necessary.
-							if (span >= (1 << 16)) {
-								exact += zeros;
-								if (zeros_per_sub64 > 1) spilled += zeros;
-							}
-						}
-						d++;
-					}
+			uint64_t spilled = 0;
+
+			// Second phase: spans are known from the inventory alone, so we can mark entries whose zeros are spilled
+			// (as they span too many bits for 16-bit offsets) and assign them space in the exact spill list.
+			for (uint64_t inventory_index = 0; inventory_index < inventory_size; inventory_index++) {
+				const uint64_t start = inventory[inventory_index * longwords_per_inventory];
+				const uint64_t span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
+				if (span >= (1 << 16) && zeros_per_sub64 > 1) {
+					inventory[inventory_index * longwords_per_inventory] |= 1ULL << 63;
+					inventory[inventory_index * longwords_per_inventory + 1] = spilled;
+					spilled += min(c - (inventory_index << log2_zeros_per_inventory), (uint64_t)zeros_per_inventory);
 				}
+			}
 
 #ifdef DEBUG
-			printf("Spilled entries: %" PRId64 " exact: %" PRId64 "\n", spilled, exact);
+			printf("Spilled entries: %" PRId64 "\n", spilled);
 #endif
 
 			exact_spill_size = spilled;
 			exact_spill.size(exact_spill_size);
 
-			uint16_t *p16;
-			int64_t *p64;
-			int offset;
-			spilled = 0;
-			d = 0;
-
-			for (uint64_t i = 0; i < num_words; i++)
-				for (int j = 0; j < 64; j++) {
-					if (i * 64 + j >= num_bits) break;
-					if (~bits[i] & 1ULL << j) {
-						if ((d & zeros_per_inventory_mask) == 0) {
-							inventory_index = d >> log2_zeros_per_inventory;
-							start = inventory[inventory_index * longwords_per_inventory];
-							span = inventory[(inventory_index + 1) * longwords_per_inventory] - start;
-							p64 = &inventory[inventory_index * longwords_per_inventory + 1];
-							p16 = (uint16_t *)p64;
-							offset = 0;
-						}
-
-						if (span < (1 << 16)) {
-							assert(i * 64 + j - start <= (1 << 16));
-							if ((d & zeros_per_sub16_mask) == 0) {
-								assert(offset < longwords_per_subinventory * 4);
-								assert(p16 + offset < (uint16_t *)end_of_inventory);
-								p16[offset++] = i * 64 + j - start;
-							}
-						} else {
-							if (zeros_per_sub64 == 1) {
-								assert(p64 + offset < end_of_inventory);
-								p64[offset++] = i * 64 + j;
-							} else {
-								assert(p64 < end_of_inventory);
-								if ((d & zeros_per_inventory_mask) == 0) {
-									inventory[inventory_index * longwords_per_inventory] |= 1ULL << 63;
-									p64[0] = spilled;
-								}
-								assert(spilled < exact_spill_size);
-								exact_spill[spilled++] = i * 64 + j;
-							}
-						}
-
-						d++;
-					}
-				}
+			// Third phase: subinventories are disjoint, so they are filled in parallel.
+			work_stealing((inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t k, size_t) {
+				for (uint64_t inventory_index = k * CHUNK_INVENTORY; inventory_index < min((k + 1) * CHUNK_INVENTORY, inventory_size); inventory_index++)
+					fillSubinventory(inventory_index, c);
+			});
 		}
 
 #ifdef DEBUG
@@ -216,7 +212,46 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 #endif
 	}
 
-	uint64_t selectZero(const uint64_t rank) {
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	SimpleSelectZero(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, log2_zeros_per_inventory, log2_zeros_per_sub16, log2_zeros_per_sub64, log2_longwords_per_subinventory, zeros_per_inventory, zeros_per_sub16, zeros_per_sub64,
+			longwords_per_subinventory, longwords_per_inventory, zeros_per_inventory_mask, zeros_per_sub16_mask, zeros_per_sub64_mask, num_words, inventory_size, exact_spill_size, num_zeros);
+		is >> inventory >> exact_spill;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	SimpleSelectZero(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, log2_zeros_per_inventory, log2_zeros_per_sub16, log2_zeros_per_sub64, log2_longwords_per_subinventory, zeros_per_inventory, zeros_per_sub16, zeros_per_sub64,
+			longwords_per_subinventory, longwords_per_inventory, zeros_per_inventory_mask, zeros_per_sub16_mask, zeros_per_sub64_mask, num_words, inventory_size, exact_spill_size, num_zeros);
+		inventory = util::Vector<int64_t, AT>::view(image);
+		exact_spill = util::Vector<uint64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const SimpleSelectZero<AT> &simple) {
+		util::write_words(os, simple.log2_zeros_per_inventory, simple.log2_zeros_per_sub16, simple.log2_zeros_per_sub64, simple.log2_longwords_per_subinventory, simple.zeros_per_inventory,
+			simple.zeros_per_sub16, simple.zeros_per_sub64, simple.longwords_per_subinventory, simple.longwords_per_inventory, simple.zeros_per_inventory_mask, simple.zeros_per_sub16_mask,
+			simple.zeros_per_sub64_mask, simple.num_words, simple.inventory_size, simple.exact_spill_size, simple.num_zeros);
+		return os << simple.inventory << simple.exact_spill;
+	}
+
+	uint64_t selectZero(const uint64_t rank) { return selectZeroKernel(rank); }
+
+  private:
+	SUX_MULTIVERSION uint64_t selectZeroKernel(const uint64_t rank) {
 #ifdef DEBUG
 		printf("Selecting %" PRId64 "\n...", rank);
 #endif
@@ -268,6 +303,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZero {
 		return word_index * 64 + select64(word, residual);
 	}
 
+  public:
 	/** Returns an estimate of the size (in bits) of this structure. */
 	size_t bitCount() const { return inventory.bitCount() - sizeof(inventory) * 8 + exact_spill.bitCount() - sizeof(exact_spill) * 8 + sizeof(*this) * 8; }
 };
@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
 #include "../util/Vector.hpp"
 #include "SelectZero.hpp"
 #include <cstdint>
+#include <vector>
 
 namespace sux::bits {
 
@@ -70,6 +73,41 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZeroHa
 
 	uint64_t num_words, inventory_size, num_zeros;
 
+	// Words and inventory entries per task of a parallel construction
+	static constexpr uint64_t CHUNK_WORDS = 1 << 16;
+	static constexpr uint64_t CHUNK_INVENTORY = 1 << 10;
+
+	/** Fills the subinventory of an inventory entry.
+	 *
+	 * Subinventories of different entries are disjoint, so they can be filled concurrently.
+	 *
+	 * @param inventory_index an inventory index.
+	 * @param num the number of zeros in the bit vector.
+	 */
+	void fillSubinventory(const uint64_t inventory_index, const uint64_t num) {
+		int64_t *const inventory_start = &inventory[inventory_index * (longwords_per_subinventory + 1)];
+		const uint64_t start = inventory_start[0];
+		const uint64_t span = inventory_start[longwords_per_subinventory + 1] - start;
+
+		// The zeros of the entry, and the number of zeros before the word containing the first zero
+		const uint64_t first = inventory_index << log2_zeros_per_inventory, last = min(num, first + zeros_per_inventory);
+		const uint64_t rank = first - nu(~bits[start / 64] & ((1ULL << start % 64) - 1));
+
+		if (span < (1 << 16)) {
+			uint16_t *const p16 = (uint16_t *)(inventory_start + 1);
+			select_every<true>(bits, start / 64, rank, first, last, log2_zeros_per_sub16, [&](const uint64_t r, const uint64_t pos) {
+				assert(pos - start <= (1 << 16));
+				assert(((r - first) >> log2_zeros_per_sub16) < longwords_per_subinventory * 4);
+				p16[(r - first) >> log2_zeros_per_sub16] = pos - start;
+			});
+		} else {
+			select_every<true>(bits, start / 64, rank, first, last, log2_zeros_per_sub64, [&](const uint64_t r, const uint64_t pos) {
+				assert(((r - first) >> log2_zeros_per_sub64) < longwords_per_subinventory);
+				inventory_start[1 + ((r - first) >> log2_zeros_per_sub64)] = pos - start;
+			});
+		}
+	}
+
   public:
 	SimpleSelectZeroHalf() {}
 
@@ -77,14 +115,21 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZeroHa
 	 *
 	 * @param bits a bit vector of 64-bit words.
 	 * @param num_bits the length (in bits) of the bit vector.
+	 * @param num_threads the number of threads used for construction; the structure does not depend on it.
 	 */
 
-	SimpleSelectZeroHalf(const uint64_t *const bits, const uint64_t num_bits) : bits(bits) {
+	SimpleSelectZeroHalf(const uint64_t *const bits, const uint64_t num_bits, const size_t num_threads = 1) : bits(bits) {
 		num_words = (num_bits + 63) / 64;
 
-		// Init rank/select structure
-		uint64_t c = 0;
-		for (uint64_t i = 0; i < num_words; i++) c += __builtin_popcountll(~bits[i]);
+		// Init rank/select structure, counting the zeros of each chunk of words
+		const uint64_t num_chunks = (num_words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+		std::vector<uint64_t> chunk_zeros(num_chunks + 1);
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			const uint64_t words = min(CHUNK_WORDS, num_words - k * CHUNK_WORDS);
+			chunk_zeros[k + 1] = words * 64 - popcount(bits + k * CHUNK_WORDS, words);
+		});
+		for (uint64_t k = 0; k < num_chunks; k++) chunk_zeros[k + 1] += chunk_zeros[k];
+		uint64_t c = chunk_zeros[num_chunks];
 		num_zeros = c;
 
 		if (num_bits % 64 != 0) c -= 64 - num_bits % 64;
@@ -100,73 +145,66 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZeroHa
 
 		inventory.size(inventory_size * (longwords_per_subinventory + 1) + 1);
 
-		uint64_t d = 0;
-		const uint64_t mask = zeros_per_inventory - 1;
+		// First phase: we build an inventory for each zero out of zeros_per_inventory, locating zeros a word at a time;
+		// the zeros past the end of the bit vector are never located, as they follow all other zeros.
+		work_stealing(num_chunks, num_threads, [&](const uint64_t k, size_t) {
+			select_every<true>(bits, k * CHUNK_WORDS, chunk_zeros[k], chunk_zeros[k], min(chunk_zeros[k + 1], c), log2_zeros_per_inventory,
+				[&](const uint64_t rank, const uint64_t pos) { inventory[(rank >> log2_zeros_per_inventory) * (longwords_per_subinventory + 1)] = pos; });
+		});
 
-		// First phase: we build an inventory for each one out of zeros_per_inventory.
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (~bits[i] & 1ULL << j) {
-					if ((d & mask) == 0) inventory[(d >> log2_zeros_per_inventory) * (longwords_per_subinventory + 1)] = i * 64 + j;
-					d++;
-				}
-			}
-
-		assert(c == d);
 		inventory[inventory_size * (longwords_per_subinventory + 1)] = num_bits;
 
 #ifdef DEBUG
 		printf("Inventory entries filled: %" PRId64 "\n", inventory_size + 1);
 #endif
 
-		uint16_t *p16;
-		int64_t *p64;
-
-		d = 0;
-		uint64_t exact = 0, start, span, inventory_index;
-		int offset;
-
-		for (uint64_t i = 0; i < num_words; i++)
-			for (int j = 0; j < 64; j++) {
-				if (i * 64 + j >= num_bits) break;
-				if (~bits[i] & 1ULL << j) {
-					if ((d & mask) == 0) {
-						inventory_index = (d >> log2_zeros_per_inventory) * (longwords_per_subinventory + 1);
-						start = inventory[inventory_index];
-						span = inventory[inventory_index + longwords_per_subinventory + 1] - start;
-						if (span > (1 << 16)) inventory[inventory_index] = -inventory[inventory_index] - 1;
-						offset = 0;
-						p64 = &inventory[inventory_index + 1];
-						p16 = (uint16_t *)p64;
-					}
-
-					if (span < (1 << 16)) {
-						assert(i * 64 + j - start <= (1 << 16));
-						if ((d & zeros_per_sub16_mask) == 0) {
-							assert(offset < longwords_per_subinventory * 4);
-							p16[offset++] = i * 64 + j - start;
-						}
-					} else {
-						if ((d & zeros_per_sub64_mask) == 0) {
-							assert(offset < longwords_per_subinventory);
-							p64[offset++] = i * 64 + j - start;
-							exact++;
-						}
-					}
-
-					d++;
-				}
-			}
+		// Second phase: subinventories are disjoint, so they are filled in parallel.
+		work_stealing((inventory_size + CHUNK_INVENTORY - 1) / CHUNK_INVENTORY, num_threads, [&](const uint64_t k, size_t) {
+			for (uint64_t inventory_index = k * CHUNK_INVENTORY; inventory_index < min((k + 1) * CHUNK_INVENTORY, inventory_size); inventory_index++) fillSubinventory(inventory_index, c);
+		});
 
-#ifdef DEBUG
-			// printf("Exact entries: %" PRId64 "\n", exact);
-			// printf("First inventories: %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 "\n", inventory[0], inventory[1], inventory[2],
-			//       inventory[3]);
-#endif
+		// Third phase: entries whose zeros span too many bits for 16-bit offsets are marked by negating them.
+		for (uint64_t inventory_index = 0; inventory_index < inventory_size; inventory_index++) {
+			int64_t *const inventory_start = &inventory[inventory_index * (longwords_per_subinventory + 1)];
+			if (inventory_start[longwords_per_subinventory + 1] - inventory_start[0] >= (1 << 16)) inventory_start[0] = -inventory_start[0] - 1;
+		}
 	}
 
-	uint64_t selectZero(const uint64_t rank) {
+	/** Loads an instance serialized by the `<<` operator.
+	 *
+	 * The bit vector is not part of the serialized data: it must be
+	 * the same bit vector the instance was built on.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param is a stream containing an instance serialized by the `<<` operator.
+	 */
+	SimpleSelectZeroHalf(const uint64_t *const bits, std::istream &is) : bits(bits) {
+		util::read_words(is, num_words, inventory_size, num_zeros);
+		is >> inventory;
+	}
+
+	/** Creates a read-only view of an instance serialized by the `<<` operator.
+	 *
+	 * No data is copied: the structure will access directly the provided
+	 * image, which is usually a util::MappedFile and must outlive the view.
+	 *
+	 * @param bits a bit vector of 64-bit words.
+	 * @param image a pointer to an instance serialized by the `<<` operator; it is advanced past the instance.
+	 */
+	SimpleSelectZeroHalf(const uint64_t *const bits, const char *&image) : bits(bits) {
+		util::view_words(image, num_words, inventory_size, num_zeros);
+		inventory = util::Vector<int64_t, AT>::view(image);
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const SimpleSelectZeroHalf<AT> &simple) {
+		util::write_words(os, simple.num_words, simple.inventory_size, simple.num_zeros);
+		return os << simple.inventory;
+	}
+
+	uint64_t selectZero(const uint64_t rank) { return selectZeroKernel(rank); }
+
+  private:
+	SUX_MULTIVERSION uint64_t selectZeroKernel(const uint64_t rank) {
 #ifdef DEBUG
 		printf("Selecting %" PRId64 "\n...", rank);
 #endif
@@ -214,6 +252,7 @@ template <util::AllocType AT = util::AllocType::MALLOC> class SimpleSelectZeroHa
 		return word_index * 64 + select64(word, residual);
 	}
 
+  public:
 	uint64_t selectZero(const uint64_t rank, uint64_t *const next) {
 		const uint64_t s = selectZero(rank);
 		int curr = s / 64;
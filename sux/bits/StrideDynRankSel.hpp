@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
 #include "../util/Vector.hpp"
 #include "DynamicBitVector.hpp"
 #include "Rank.hpp"
@@ -49,7 +50,10 @@ namespace sux::bits {
  * @tparam AT a type of memory allocation for the underlying structure.
  */
 template <template <size_t, util::AllocType AT> class SPS, size_t WORDS, util::AllocType AT = util::AllocType::MALLOC>
-class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, public SelectZero {
+class StrideDynRankSel : public DynamicBitVector,
+						 public StaticRank<StrideDynRankSel<SPS, WORDS, AT>>,
+						 public StaticSelect<StrideDynRankSel<SPS, WORDS, AT>>,
+						 public StaticSelectZero<StrideDynRankSel<SPS, WORDS, AT>> {
   private:
 	static constexpr size_t BOUND = 64 * WORDS;
 	uint64_t *const Vector;
@@ -75,48 +79,7 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 
 	uint64_t *bitvector() const { return Vector; }
 
-	virtual uint64_t rank(size_t pos) {
-		size_t idx = pos / (64 * WORDS);
-		uint64_t value = SrcPrefSum.prefix(idx);
-
-		for (size_t i = idx * WORDS; i < pos / 64; i++) value += nu(Vector[i]);
-
-		return value + nu(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1));
-	}
-
-	using Rank::rank;
-	using Rank::rankZero;
-	virtual uint64_t rank(size_t from, size_t to) { return rank(to) - rank(from); }
-
-	virtual size_t select(uint64_t rank) {
-		size_t idx = SrcPrefSum.find(&rank);
-
-		for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
-			uint64_t rank_chunk = nu(Vector[i]);
-			if (rank < rank_chunk)
-				return i * 64 + select64(Vector[i], rank);
-			else
-				rank -= rank_chunk;
-		}
-
-		return SIZE_MAX;
-	}
-
-	virtual size_t selectZero(uint64_t rank) {
-		size_t idx = SrcPrefSum.compFind(&rank);
-
-		for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
-			uint64_t rank_chunk = nu(~Vector[i]);
-			if (rank < rank_chunk)
-				return i * 64 + select64(~Vector[i], rank);
-			else
-				rank -= rank_chunk;
-		}
-
-		return SIZE_MAX;
-	}
-
-	virtual uint64_t update(size_t index, uint64_t word) {
+	uint64_t update(size_t index, uint64_t word) final {
 		uint64_t old = Vector[index];
 		Vector[index] = word;
 		SrcPrefSum.add(index / WORDS + 1, nu(word) - nu(old));
@@ -124,7 +87,7 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 		return old;
 	}
 
-	virtual bool set(size_t index) {
+	bool set(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] |= uint64_t(1) << (index % 64);
 
@@ -136,7 +99,7 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 		return true;
 	}
 
-	virtual bool clear(size_t index) {
+	bool clear(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] &= ~(uint64_t(1) << (index % 64));
 
@@ -148,7 +111,7 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 		return false;
 	}
 
-	virtual bool toggle(size_t index) {
+	bool toggle(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] ^= uint64_t(1) << (index % 64);
 		bool was_set = Vector[index / 64] < old;
@@ -162,6 +125,47 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 	virtual size_t bitCount() const { return SrcPrefSum.bitCount() - sizeof(SrcPrefSum) * 8 + sizeof(*this) * 8 + ((Size + 63) & ~63); }
 
   private:
+	friend StaticRank<StrideDynRankSel<SPS, WORDS, AT>>;
+	friend StaticSelect<StrideDynRankSel<SPS, WORDS, AT>>;
+	friend StaticSelectZero<StrideDynRankSel<SPS, WORDS, AT>>;
+
+	uint64_t rankKernel(size_t pos) {
+		size_t idx = pos / (64 * WORDS);
+		uint64_t value = SrcPrefSum.prefix(idx);
+
+		for (size_t i = idx * WORDS; i < pos / 64; i++) value += nu(Vector[i]);
+
+		return value + nu(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1));
+	}
+
+	size_t selectKernel(uint64_t rank) {
+		size_t idx = SrcPrefSum.find(&rank);
+
+		for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
+			uint64_t rank_chunk = nu(Vector[i]);
+			if (rank < rank_chunk)
+				return i * 64 + select64(Vector[i], rank);
+			else
+				rank -= rank_chunk;
+		}
+
+		return SIZE_MAX;
+	}
+
+	size_t selectZeroKernel(uint64_t rank) {
+		size_t idx = SrcPrefSum.compFind(&rank);
+
+		for (size_t i = idx * WORDS; i < idx * WORDS + WORDS; i++) {
+			uint64_t rank_chunk = nu(~Vector[i]);
+			if (rank < rank_chunk)
+				return i * 64 + select64(~Vector[i], rank);
+			else
+				rank -= rank_chunk;
+		}
+
+		return SIZE_MAX;
+	}
+
 	static size_t divRoundup(size_t x, size_t y) {
 		if (y > x) return 1;
 		return (x / y) + ((x % y != 0) ? 1 : 0);
@@ -169,7 +173,7 @@ class StrideDynRankSel : public DynamicBitVector, public Rank, public Select, pu
 
 	static SPS<BOUND, AT> buildSrcPrefSum(const uint64_t bitvector[], size_t size) {
 		unique_ptr<uint64_t[]> sequence = make_unique<uint64_t[]>(divRoundup(size, WORDS));
-		for (size_t i = 0; i < size; i++) sequence[i / WORDS] += nu(bitvector[i]);
+		popcount_blocks(bitvector, size, WORDS, sequence.get());
 		return SPS<BOUND, AT>(sequence.get(), divRoundup(size, WORDS));
 	}
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "../support/Popcount.hpp"
 #include "../util/Vector.hpp"
 #include "DynamicBitVector.hpp"
 #include "Rank.hpp"
@@ -53,7 +54,11 @@ namespace sux::bits {
  * @tparam AT a type of memory allocation for the underlying structure.
  */
 
-template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT = util::AllocType::MALLOC> class WordDynRankSel : public DynamicBitVector, public Rank, public Select, public SelectZero {
+template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT = util::AllocType::MALLOC>
+class WordDynRankSel : public DynamicBitVector,
+					   public StaticRank<WordDynRankSel<SPS, AT>>,
+					   public StaticSelect<WordDynRankSel<SPS, AT>>,
+					   public StaticSelectZero<WordDynRankSel<SPS, AT>> {
   private:
 	static constexpr size_t BOUND = 64;
 	uint64_t *const Vector;
@@ -79,28 +84,7 @@ template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT =
 
 	uint64_t *bitvector() const { return Vector; }
 
-	using Rank::rank;
-	using Rank::rankZero;
-	virtual uint64_t rank(size_t pos) { return SrcPrefSum.prefix(pos / 64) + nu(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1)); }
-
-	virtual size_t select(uint64_t rank) {
-		size_t idx = SrcPrefSum.find(&rank);
-		uint64_t rank_chunk = nu(Vector[idx]);
-		if (rank < rank_chunk) return idx * 64 + select64(Vector[idx], rank);
-
-		return SIZE_MAX;
-	}
-
-	virtual size_t selectZero(uint64_t rank) {
-		const size_t idx = SrcPrefSum.compFind(&rank);
-
-		uint64_t rank_chunk = nu(~Vector[idx]);
-		if (rank < rank_chunk) return idx * 64 + select64(~Vector[idx], rank);
-
-		return SIZE_MAX;
-	}
-
-	virtual uint64_t update(size_t index, uint64_t word) {
+	uint64_t update(size_t index, uint64_t word) final {
 		uint64_t old = Vector[index];
 		Vector[index] = word;
 		SrcPrefSum.add(index + 1, nu(word) - nu(old));
@@ -108,7 +92,7 @@ template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT =
 		return old;
 	}
 
-	virtual bool set(size_t index) {
+	bool set(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] |= uint64_t(1) << (index % 64);
 
@@ -120,7 +104,7 @@ template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT =
 		return true;
 	}
 
-	virtual bool clear(size_t index) {
+	bool clear(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] &= ~(uint64_t(1) << (index % 64));
 
@@ -132,7 +116,7 @@ template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT =
 		return false;
 	}
 
-	virtual bool toggle(size_t index) {
+	bool toggle(size_t index) final {
 		uint64_t old = Vector[index / 64];
 		Vector[index / 64] ^= uint64_t(1) << (index % 64);
 		bool was_set = Vector[index / 64] < old;
@@ -146,11 +130,34 @@ template <template <size_t, util::AllocType AT> class SPS, util::AllocType AT =
 	virtual size_t bitCount() const { return SrcPrefSum.bitCount() - sizeof(SrcPrefSum) * 8 + sizeof(*this) * 8 + ((Size + 63) & ~63); }
 
   private:
+	friend StaticRank<WordDynRankSel<SPS, AT>>;
+	friend StaticSelect<WordDynRankSel<SPS, AT>>;
+	friend StaticSelectZero<WordDynRankSel<SPS, AT>>;
+
+	uint64_t rankKernel(size_t pos) { return SrcPrefSum.prefix(pos / 64) + nu(Vector[pos / 64] & ((1ULL << (pos % 64)) - 1)); }
+
+	size_t selectKernel(uint64_t rank) {
+		size_t idx = SrcPrefSum.find(&rank);
+		uint64_t rank_chunk = nu(Vector[idx]);
+		if (rank < rank_chunk) return idx * 64 + select64(Vector[idx], rank);
+
+		return SIZE_MAX;
+	}
+
+	size_t selectZeroKernel(uint64_t rank) {
+		const size_t idx = SrcPrefSum.compFind(&rank);
+
+		uint64_t rank_chunk = nu(~Vector[idx]);
+		if (rank < rank_chunk) return idx * 64 + select64(~Vector[idx], rank);
+
+		return SIZE_MAX;
+	}
+
 	static size_t divRoundup(size_t x, size_t y) { return (x + y - 1) / y; }
 
 	SPS<BOUND, AT> buildSrcPrefSum(const uint64_t bitvector[], size_t size) {
 		unique_ptr<uint64_t[]> sequence = make_unique<uint64_t[]>(size);
-		for (size_t i = 0; i < size; i++) sequence[i] = nu(bitvector[i]);
+		popcount_blocks(bitvector, size, 1, sequence.get());
 		return SPS<BOUND, AT>(sequence.get(), size);
 	}
 
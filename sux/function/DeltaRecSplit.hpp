@@ -0,0 +1,323 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Emmanuel Esposito and Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "RecSplit.hpp"
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sux::function {
+
+using namespace std;
+
+/** An updatable minimal perfect hash function built on RecSplit.
+ *
+ * Keys are partitioned into shards, each one mapped by an immutable RecSplit
+ * instance. Additions and deletions are recorded in a small delta layer: added
+ * keys are kept in a hash table and are assigned the values freed by deleted keys
+ * (or new values past the end, if there are no free values). A compact filter on
+ * the added keys makes it possible to skip the delta layer with a single probe,
+ * so that the common case costs just one RecSplit evaluation.
+ *
+ * Until the next merge(), values of keys not involved in updates do not change,
+ * but the function is minimal only if the number of additions is at least the
+ * number of deletions. Calling merge() returns a new instance in which only the shards
+ * containing updated keys have been rebuilt, and whose values are again exactly
+ * the range [0..size()). Since merge() is `const` and unaffected shards are shared,
+ * it can run in a background thread while the current instance keeps serving
+ * queries; the caller then swaps instances.
+ *
+ * A deleted key can be added again: it is then handled by the delta layer as any other added key.
+ *
+ * To rebuild shards, this class keeps the 128-bit hash of every key (in order of
+ * value inside its shard); as a side effect, contains() answers exact membership queries.
+ *
+ * As for RecSplit, querying a key that is not in the set returns an arbitrary value.
+ *
+ * @tparam LEAF_SIZE the size of a leaf of the underlying RecSplit instances.
+ * @tparam AT a type of memory allocation out of sux::util::AllocType.
+ */
+
+template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class DeltaRecSplit {
+	struct Shard {
+		RecSplit<LEAF_SIZE, AT> rs;
+		// keys[v] is the key with (shard-local) value v
+		vector<hash128_t> keys;
+	};
+
+	struct Hash128Hash {
+		size_t operator()(const hash128_t &h) const { return h.first ^ h.second; }
+	};
+
+	struct Hash128Equal {
+		bool operator()(const hash128_t &a, const hash128_t &b) const { return a.first == b.first && a.second == b.second; }
+	};
+
+	// Bits per added key in the filter, and number of probes
+	static constexpr size_t filter_bits_per_key = 16;
+	static constexpr int filter_probes = 2;
+
+	size_t bucket_size;
+	vector<shared_ptr<Shard>> shards;
+	vector<uint64_t> offset; // offset[s] is the first value of shard s; offset[num_shards] is the base size
+	size_t next_value;       // first value never assigned
+
+	unordered_map<hash128_t, uint64_t, Hash128Hash, Hash128Equal> added;
+	unordered_set<hash128_t, Hash128Hash, Hash128Equal> deleted;
+	vector<uint64_t> free_values;
+	vector<uint64_t> filter;
+	uint64_t filter_mask = 0;
+
+  public:
+	DeltaRecSplit() : offset{0}, next_value(0) {}
+
+	/** Builds an instance using a given list of 128-bit hashes.
+	 *
+	 * **Warning**: duplicate keys will cause this method to never return.
+	 *
+	 * @param keys a vector of 128-bit hashes.
+	 * @param bucket_size the bucket size of the underlying RecSplit instances.
+	 * @param num_shards the number of shards; smaller shards make merges cheaper.
+	 */
+	DeltaRecSplit(const vector<hash128_t> &keys, const size_t bucket_size, const size_t num_shards) : bucket_size(bucket_size) {
+		assert(num_shards > 0);
+		vector<vector<hash128_t>> part(num_shards);
+		for (const auto &k : keys) part[shard(k, num_shards)].push_back(k);
+		shards.resize(num_shards);
+		for (size_t s = 0; s < num_shards; s++) shards[s] = build_shard(part[s]);
+		compute_offsets();
+	}
+
+	/** Builds an instance using a given list of keys.
+	 *
+	 * **Warning**: duplicate keys will cause this method to never return.
+	 *
+	 * @param keys a vector of strings.
+	 * @param bucket_size the bucket size of the underlying RecSplit instances.
+	 * @param num_shards the number of shards; smaller shards make merges cheaper.
+	 */
+	DeltaRecSplit(const vector<string> &keys, const size_t bucket_size, const size_t num_shards) : DeltaRecSplit(hash_keys(keys), bucket_size, num_shards) {}
+
+	/** Returns the value associated with the given 128-bit hash.
+	 *
+	 * @param hash a 128-bit hash.
+	 * @return the associated value.
+	 */
+	size_t operator()(const hash128_t &hash) {
+		if (unlikely(maybe_added(hash))) {
+			const auto it = added.find(hash);
+			if (it != added.end()) return it->second;
+		}
+		const size_t s = shard(hash, shards.size());
+		// Empty shards have no function (their RecSplit is default-constructed)
+		if (shards[s]->keys.empty()) return offset[s];
+		return offset[s] + shards[s]->rs(hash);
+	}
+
+	/** Returns the value associated with the given key.
+	 *
+	 * @param key a key.
+	 * @return the associated value.
+	 */
+	size_t operator()(const string &key) { return operator()(first_hash(key.c_str(), key.size())); }
+
+	/** Returns whether the given 128-bit hash is currently in the key set.
+	 *
+	 * @param hash a 128-bit hash.
+	 */
+	bool contains(const hash128_t &hash) {
+		if (maybe_added(hash) && added.count(hash)) return true;
+		if (deleted.count(hash)) return false;
+		const size_t s = shard(hash, shards.size());
+		const auto &keys = shards[s]->keys;
+		if (keys.empty()) return false;
+		const hash128_t &k = keys[shards[s]->rs(hash)];
+		return k.first == hash.first && k.second == hash.second;
+	}
+
+	/** Returns whether the given key is currently in the key set.
+	 *
+	 * @param key a key.
+	 */
+	bool contains(const string &key) { return contains(first_hash(key.c_str(), key.size())); }
+
+	/** Adds a 128-bit hash to the key set.
+	 *
+	 * @param hash a 128-bit hash that is not in the key set.
+	 * @return the value assigned to `hash`.
+	 */
+	size_t add(const hash128_t &hash) {
+		assert(!contains(hash));
+		uint64_t value;
+		if (free_values.empty()) {
+			value = next_value++;
+		} else {
+			value = free_values.back();
+			free_values.pop_back();
+		}
+
+		added[hash] = value;
+		if (added.size() * filter_bits_per_key > filter.size() * 64) rebuild_filter();
+		else
+			filter_set(hash);
+		return value;
+	}
+
+	/** Adds a key to the key set.
+	 *
+	 * @param key a key that is not in the key set.
+	 * @return the value assigned to `key`.
+	 */
+	size_t add(const string &key) { return add(first_hash(key.c_str(), key.size())); }
+
+	/** Removes a 128-bit hash from the key set.
+	 *
+	 * The value of the hash becomes free and will be assigned to the next added key.
+	 *
+	 * @param hash a 128-bit hash in the key set.
+	 */
+	void remove(const hash128_t &hash) {
+		assert(contains(hash));
+		const auto it = added.find(hash);
+		if (it != added.end()) {
+			free_values.push_back(it->second);
+			added.erase(it);
+			// The filter bits are left set: they just cause a few false positives until the next merge
+		} else {
+			free_values.push_back(operator()(hash));
+			deleted.insert(hash);
+		}
+	}
+
+	/** Removes a key from the key set.
+	 *
+	 * @param key a key in the key set.
+	 */
+	void remove(const string &key) { remove(first_hash(key.c_str(), key.size())); }
+
+	/** Returns a new instance representing the current key set, with an empty delta layer.
+	 *
+	 * Only shards containing added or deleted keys are rebuilt; the other shards are
+	 * shared with this instance. Values of keys in rebuilt shards change, and values
+	 * in all following shards are shifted so that the new instance is minimal.
+	 *
+	 * This method does not modify this instance, so it can be run in a background
+	 * thread as long as there are no concurrent updates.
+	 */
+	DeltaRecSplit merge() const {
+		const size_t num_shards = shards.size();
+		vector<bool> dirty(num_shards);
+		for (const auto &e : added) dirty[shard(e.first, num_shards)] = true;
+		for (const auto &k : deleted) dirty[shard(k, num_shards)] = true;
+
+		DeltaRecSplit result;
+		result.bucket_size = bucket_size;
+		result.shards = shards;
+
+		for (size_t s = 0; s < num_shards; s++) {
+			if (!dirty[s]) continue;
+			vector<hash128_t> keys;
+			keys.reserve(shards[s]->keys.size());
+			for (const auto &k : shards[s]->keys)
+				if (!deleted.count(k)) keys.push_back(k);
+			for (const auto &e : added)
+				if (shard(e.first, num_shards) == s) keys.push_back(e.first);
+			result.shards[s] = build_shard(keys);
+		}
+
+		result.compute_offsets();
+		return result;
+	}
+
+	/** Returns the number of keys currently in the key set. */
+	size_t size() const { return offset[shards.size()] - deleted.size() + added.size(); }
+
+	/** Returns the number of shards. */
+	size_t numShards() const { return shards.size(); }
+
+	/** Returns the number of pending updates, that is, the size of the delta layer. */
+	size_t deltaSize() const { return added.size() + deleted.size(); }
+
+  private:
+	static size_t shard(const hash128_t &hash, const size_t num_shards) {
+		// RecSplit uses the first half for buckets and the second for splittings, so we mix both
+		return remap128(remix(hash.first + hash.second), num_shards);
+	}
+
+	static vector<hash128_t> hash_keys(const vector<string> &keys) {
+		vector<hash128_t> h(keys.size(), hash128_t(0, 0));
+		spooky_batch(keys.data(), keys.size(), 0, h.data());
+		return h;
+	}
+
+	shared_ptr<Shard> build_shard(vector<hash128_t> &keys) const {
+		auto result = make_shared<Shard>();
+		if (keys.empty()) return result;
+		result->keys = vector<hash128_t>(keys.size(), hash128_t(0, 0));
+		result->rs = RecSplit<LEAF_SIZE, AT>(keys, bucket_size);
+		for (const auto &k : keys) result->keys[result->rs(k)] = k;
+		return result;
+	}
+
+	void compute_offsets() {
+		offset.resize(shards.size() + 1);
+		offset[0] = 0;
+		for (size_t s = 0; s < shards.size(); s++) offset[s + 1] = offset[s] + shards[s]->keys.size();
+		next_value = offset[shards.size()];
+	}
+
+	inline bool maybe_added(const hash128_t &hash) const {
+		if (likely(filter_mask == 0)) return false;
+		uint64_t h = hash.first ^ hash.second;
+		for (int i = 0; i < filter_probes; i++, h >>= 32) {
+			const uint64_t bit = remix(h) & filter_mask;
+			if ((filter[bit / 64] & UINT64_C(1) << bit % 64) == 0) return false;
+		}
+		return true;
+	}
+
+	inline void filter_set(const hash128_t &hash) {
+		uint64_t h = hash.first ^ hash.second;
+		for (int i = 0; i < filter_probes; i++, h >>= 32) {
+			const uint64_t bit = remix(h) & filter_mask;
+			filter[bit / 64] |= UINT64_C(1) << bit % 64;
+		}
+	}
+
+	void rebuild_filter() {
+		const uint64_t bits = round_pow2(max(64, added.size() * filter_bits_per_key * 2));
+		filter.assign(bits / 64, 0);
+		filter_mask = bits - 1;
+		for (const auto &e : added) filter_set(e.first);
+	}
+};
+
+} // namespace sux::function
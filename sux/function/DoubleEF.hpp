@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include "../support/WorkStealing.hpp"
 #include "../support/common.hpp"
+#include <algorithm>
 #include "../util/Vector.hpp"
 #include <cstdint>
 #include <cstring>
@@ -47,7 +49,13 @@ using namespace sux::util;
 
 /** A double Elias-Fano list.
  *
- * This class exists solely to implement RecSplit.
+ * This class was written to implement RecSplit, but it can be used as a
+ * standalone index of offsets: it stores a nondecreasing sequence of counts
+ * (e.g., cumulative keys) and a sequence of positions that are roughly
+ * proportional to the counts (e.g., bit offsets of variable-length records).
+ * Large numbers of lookups should use the batch versions of get(), which
+ * prefetch the data involved in several lookups at a time.
+ *
  * @tparam AT a type of memory allocation out of util::AllocType.
  */
 
@@ -59,9 +67,11 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 	static constexpr uint64_t super_q = 1 << 14;
 	static constexpr uint64_t super_q_mask = super_q - 1;
 	static constexpr uint64_t q_per_super_q = super_q / q;
-	static constexpr uint64_t super_q_size = 1 + q_per_super_q / 4;
 	Vector<uint64_t, AT> lower_bits, upper_bits_position, upper_bits_cum_keys, jump;
 	uint64_t lower_bits_mask_cum_keys, lower_bits_mask_position;
+	// Width in bits of the offsets in the jump table (16, unless some offset does not fit), and words per superblock
+	int jump_width = 16;
+	uint64_t super_q_words = jump_block_words(16, q_per_super_q);
 
 	uint64_t num_buckets, u_cum_keys, u_position;
 	uint64_t l_position, l_cum_keys;
@@ -78,16 +88,77 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 		memcpy((uint8_t *)&bits + start / 8, &t, 8);
 	}
 
+	// Number of lookups whose memory accesses are overlapped by the batch versions of get()
+	static constexpr size_t PREFETCH_BATCH = 16;
+
+	__inline uint64_t jump_cum_keys(const uint64_t i) const {
+		const uint64_t jump_super_q = (i / super_q) * super_q_words;
+		return jump[jump_super_q] + jump_offset(jump_super_q, 2 * ((i % super_q) / q));
+	}
+
+	__inline uint64_t jump_position(const uint64_t i) const {
+		const uint64_t jump_super_q = (i / super_q) * super_q_words;
+		return jump[jump_super_q + 1] + jump_offset(jump_super_q, 2 * ((i % super_q) / q) + 1);
+	}
+
+	// Prefetches, in two rounds, the jump table entries and then the upper bits used by a batch of lookups.
+	void prefetch(const uint64_t *index, const size_t n) const {
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t i = index[j];
+			const uint64_t jump_super_q = (i / super_q) * super_q_words;
+			__builtin_prefetch(&jump + jump_super_q);
+			__builtin_prefetch((uint8_t *)(&jump + jump_super_q + 2) + 2 * ((i % super_q) / q) * jump_width / 8);
+			__builtin_prefetch((uint8_t *)&lower_bits + i * (l_cum_keys + l_position) / 8);
+		}
+		for (size_t j = 0; j < n; j++) {
+			const uint64_t i = index[j];
+			// Elements take about two upper bits each, so the scan from the jump target spans at most a few cache lines
+			const uint64_t word_cum_keys = jump_cum_keys(i) / 64, word_position = jump_position(i) / 64;
+			__builtin_prefetch(&upper_bits_cum_keys + word_cum_keys);
+			__builtin_prefetch(&upper_bits_cum_keys + word_cum_keys + 8);
+			__builtin_prefetch(&upper_bits_position + word_position);
+			__builtin_prefetch(&upper_bits_position + word_position + 8);
+		}
+	}
+
 	__inline size_t lower_bits_size_words() const { return ((num_buckets + 1) * (l_cum_keys + l_position) + 63) / 64 + 1; }
 
 	__inline size_t cum_keys_size_words() const { return (num_buckets + 1 + (u_cum_keys >> l_cum_keys) + 63) / 64; }
 
 	__inline size_t position_size_words() const { return (num_buckets + 1 + (u_position >> l_position) + 63) / 64; }
 
-	__inline size_t jump_size_words() const {
-		size_t size = (num_buckets / super_q) * super_q_size * 2;                                        // Whole blocks
-		if (num_buckets % super_q != 0) size += (1 + ((num_buckets % super_q + q - 1) / q + 3) / 4) * 2; // Partial block
-		return size;
+	// Words used by a superblock with the given number of blocks: two absolute positions, and two offsets per block
+	static constexpr uint64_t jump_block_words(const int width, const uint64_t blocks) { return 2 + 2 * ((blocks * width + 63) / 64); }
+
+	__inline size_t jump_size_words(const int width) const {
+		size_t size = (num_buckets / super_q) * jump_block_words(width, q_per_super_q);                               // Whole blocks
+		if (num_buckets % super_q != 0) size += jump_block_words(width, (num_buckets % super_q + q - 1) / q); // Partial block
+		// Wider offsets are marked by an additional word containing the width
+		return width == 16 ? size : size + 1;
+	}
+
+	__inline size_t jump_size_words() const { return jump_size_words(jump_width); }
+
+	void set_jump_width(const int width) {
+		jump_width = width;
+		super_q_words = jump_block_words(width, q_per_super_q);
+	}
+
+	// Returns the e-th offset (two for each block) of a superblock starting at the given word of the jump table.
+	__inline uint64_t jump_offset(const uint64_t jump_super_q, const uint64_t e) const {
+		const uint64_t *offsets = &jump + jump_super_q + 2;
+		if (likely(jump_width == 16)) return ((uint16_t *)offsets)[e];
+		if (jump_width == 32) return ((uint32_t *)offsets)[e];
+		return offsets[e];
+	}
+
+	__inline void set_jump_offset(const uint64_t jump_super_q, const uint64_t e, const uint64_t offset) {
+		uint64_t *offsets = &jump + jump_super_q + 2;
+		if (jump_width == 16) ((uint16_t *)offsets)[e] = offset;
+		else if (jump_width == 32)
+			((uint32_t *)offsets)[e] = offset;
+		else
+			offsets[e] = offset;
 	}
 
 	friend std::ostream &operator<<(std::ostream &os, const DoubleEF<AT> &ef) {
@@ -124,13 +195,21 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 		is >> ef.upper_bits_cum_keys;
 		is >> ef.upper_bits_position;
 		is >> ef.jump;
+		ef.set_jump_width(ef.jump.size() == ef.jump_size_words(16) ? 16 : ef.jump[ef.jump.size() - 1]);
 		return is;
 	}
 
   public:
 	DoubleEF() {}
 
-	DoubleEF(const std::vector<uint64_t> &cum_keys, const std::vector<uint64_t> &position) {
+	/** Creates a new instance.
+	 *
+	 * @param cum_keys a nondecreasing sequence of counts.
+	 * @param position a sequence of positions such that the difference of consecutive positions
+	 * is roughly proportional to the difference of consecutive counts.
+	 * @param num_threads the number of threads used to build the jump tables.
+	 */
+	DoubleEF(const std::vector<uint64_t> &cum_keys, const std::vector<uint64_t> &position, const size_t num_threads = 1) {
 		assert(cum_keys.size() == position.size());
 		num_buckets = cum_keys.size() - 1;
 
@@ -179,36 +258,39 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 			set(upper_bits_position, ((pval - bit_delta) >> l_position) + i);
 		}
 
+		// The jump tables record the position in the upper bits of every q-th element, which we can compute
+		// directly from the values. Superblocks are independent, so they are processed in parallel.
+		const uint64_t num_super_q = (num_buckets + super_q - 1) / super_q;
+		const auto upper_cum_keys = [&](const uint64_t i) { return ((cum_keys[i] - i * cum_keys_min_delta) >> l_cum_keys) + i; };
+		const auto upper_position = [&](const uint64_t i) {
+			const auto pval = int64_t(position[i]) - int64_t(bits_per_key_fixed_point * cum_keys[i] >> 20);
+			return ((pval - int64_t(i * min_diff)) >> l_position) + i;
+		};
+
+		// First pass: find the largest offset, and thus the width of the offsets
+		std::vector<uint64_t> max_offset(num_super_q);
+		work_stealing(num_super_q, num_threads, [&](const uint64_t sq, size_t) {
+			const uint64_t first = sq * super_q, last = std::min(first + super_q, num_buckets);
+			max_offset[sq] = std::max(upper_cum_keys(last) - upper_cum_keys(first), upper_position(last) - upper_position(first));
+		});
+		const uint64_t max_off = num_super_q == 0 ? 0 : *std::max_element(max_offset.begin(), max_offset.end());
+		set_jump_width(max_off < (UINT64_C(1) << 16) ? 16 : max_off < (UINT64_C(1) << 32) ? 32 : 64);
+
 		const uint64_t jump_words = jump_size_words();
 		jump.size(jump_words);
-
-		for (uint64_t i = 0, c = 0, last_super_q = 0; i < words_cum_keys; i++) {
-			for (int b = 0; b < 64; b++) {
-				if (upper_bits_cum_keys[i] & UINT64_C(1) << b) {
-					if ((c & super_q_mask) == 0) jump[(c / super_q) * (super_q_size * 2)] = last_super_q = i * 64 + b;
-					if ((c & q_mask) == 0) {
-						const uint64_t offset = i * 64 + b - last_super_q;
-						if (offset >= (1 << 16)) abort();
-						((uint16_t *)(&jump + (c / super_q) * (super_q_size * 2) + 2))[2 * ((c % super_q) / q)] = offset;
-					}
-					c++;
-				}
+		if (jump_width != 16) jump[jump_words - 1] = jump_width;
+
+		// Second pass: fill the superblocks (the sentinel element of index num_buckets is stored too, if there is room)
+		work_stealing(num_super_q, num_threads, [&](const uint64_t sq, size_t) {
+			const uint64_t jump_super_q = sq * super_q_words;
+			const uint64_t base_cum_keys = jump[jump_super_q] = upper_cum_keys(sq * super_q);
+			const uint64_t base_position = jump[jump_super_q + 1] = upper_position(sq * super_q);
+			const uint64_t words = sq == num_buckets / super_q ? jump_block_words(jump_width, (num_buckets % super_q + q - 1) / q) : super_q_words;
+			for (uint64_t c = sq * super_q + q, b = 1; c < (sq + 1) * super_q && c <= num_buckets && b < (words - 2) * 64 / (2 * jump_width); c += q, b++) {
+				set_jump_offset(jump_super_q, 2 * b, upper_cum_keys(c) - base_cum_keys);
+				set_jump_offset(jump_super_q, 2 * b + 1, upper_position(c) - base_position);
 			}
-		}
-
-		for (uint64_t i = 0, c = 0, last_super_q = 0; i < words_position; i++) {
-			for (int b = 0; b < 64; b++) {
-				if (upper_bits_position[i] & UINT64_C(1) << b) {
-					if ((c & super_q_mask) == 0) jump[(c / super_q) * (super_q_size * 2) + 1] = last_super_q = i * 64 + b;
-					if ((c & q_mask) == 0) {
-						const uint64_t offset = i * 64 + b - last_super_q;
-						if (offset >= (1 << 16)) abort();
-						((uint16_t *)(&jump + (c / super_q) * (super_q_size * 2) + 2))[2 * ((c % super_q) / q) + 1] = offset;
-					}
-					c++;
-				}
-			}
-		}
+		});
 
 #ifndef NDEBUG
 		for (uint64_t i = 0; i < num_buckets; i++) {
@@ -232,10 +314,10 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 		memcpy(&lower, (uint8_t *)&lower_bits + pos_lower / 8, 8);
 		lower >>= pos_lower % 8;
 
-		const uint64_t jump_super_q = (i / super_q) * super_q_size * 2;
+		const uint64_t jump_super_q = (i / super_q) * super_q_words;
 		const uint64_t jump_inside_super_q = (i % super_q) / q;
-		const uint64_t jump_cum_keys = jump[jump_super_q] + ((uint16_t *)(&jump + jump_super_q + 2))[2 * jump_inside_super_q];
-		const uint64_t jump_position = jump[jump_super_q + 1] + ((uint16_t *)(&jump + jump_super_q + 2))[2 * jump_inside_super_q + 1];
+		const uint64_t jump_cum_keys = jump[jump_super_q] + jump_offset(jump_super_q, 2 * jump_inside_super_q);
+		const uint64_t jump_position = jump[jump_super_q + 1] + jump_offset(jump_super_q, 2 * jump_inside_super_q + 1);
 
 		uint64_t curr_word_cum_keys = jump_cum_keys / 64;
 		uint64_t curr_word_position = jump_position / 64;
@@ -269,10 +351,10 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 		memcpy(&lower, (uint8_t *)&lower_bits + pos_lower / 8, 8);
 		lower >>= pos_lower % 8;
 
-		const uint64_t jump_super_q = (i / super_q) * super_q_size * 2;
+		const uint64_t jump_super_q = (i / super_q) * super_q_words;
 		const uint64_t jump_inside_super_q = (i % super_q) / q;
-		const uint64_t jump_cum_keys = jump[jump_super_q] + ((uint16_t *)(&jump + jump_super_q + 2))[2 * jump_inside_super_q];
-		const uint64_t jump_position = jump[jump_super_q + 1] + ((uint16_t *)(&jump + jump_super_q + 2))[2 * jump_inside_super_q + 1];
+		const uint64_t jump_cum_keys = jump[jump_super_q] + jump_offset(jump_super_q, 2 * jump_inside_super_q);
+		const uint64_t jump_position = jump[jump_super_q + 1] + jump_offset(jump_super_q, 2 * jump_inside_super_q + 1);
 
 		uint64_t curr_word_cum_keys = jump_cum_keys / 64;
 		uint64_t curr_word_position = jump_position / 64;
@@ -294,6 +376,42 @@ template <util::AllocType AT = util::AllocType::MALLOC> class DoubleEF {
 				   int64_t(bits_per_key_fixed_point * cum_keys >> 20);
 	}
 
+	/** Retrieves the counts and positions associated with a batch of indices.
+	 *
+	 * The result is the same as calling get(const uint64_t, uint64_t &, uint64_t &, uint64_t &)
+	 * on each index, but the jump tables and the upper bits for several indices are
+	 * prefetched in advance, so that cache misses of different lookups overlap.
+	 *
+	 * @param index an array of `n` indices.
+	 * @param n the number of indices.
+	 * @param cum_keys an array of `n` elements that will be filled with the counts.
+	 * @param cum_keys_next an array of `n` elements that will be filled with the following counts.
+	 * @param position an array of `n` elements that will be filled with the positions.
+	 */
+	void get(const uint64_t *index, const size_t n, uint64_t *cum_keys, uint64_t *cum_keys_next, uint64_t *position) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			prefetch(index + base, b);
+			for (size_t j = base; j < base + b; j++) get(index[j], cum_keys[j], cum_keys_next[j], position[j]);
+		}
+	}
+
+	/** Retrieves the counts and positions associated with a batch of indices.
+	 *
+	 * @param index an array of `n` indices.
+	 * @param n the number of indices.
+	 * @param cum_keys an array of `n` elements that will be filled with the counts.
+	 * @param position an array of `n` elements that will be filled with the positions.
+	 * @see get(const uint64_t *, const size_t, uint64_t *, uint64_t *, uint64_t *)
+	 */
+	void get(const uint64_t *index, const size_t n, uint64_t *cum_keys, uint64_t *position) {
+		for (size_t base = 0; base < n; base += PREFETCH_BATCH) {
+			const size_t b = std::min(PREFETCH_BATCH, n - base);
+			prefetch(index + base, b);
+			for (size_t j = base; j < base + b; j++) get(index[j], cum_keys[j], position[j]);
+		}
+	}
+
 	uint64_t bitCountCumKeys() { return (num_buckets + 1) * l_cum_keys + num_buckets + 1 + (u_cum_keys >> l_cum_keys) + jump_size_words() / 2; }
 
 	uint64_t bitCountPosition() { return (num_buckets + 1) * l_position + num_buckets + 1 + (u_position >> l_position) + jump_size_words() / 2; }
@@ -0,0 +1,244 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Emmanuel Esposito and Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../support/common.hpp"
+#include "../util/Vector.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace sux::function {
+
+using namespace sux;
+using namespace sux::util;
+
+/** A co-indexed Elias-Fano representation of N monotone sequences of the same length.
+ *
+ * This class generalizes DoubleEF: the lower bits of the i-th elements of all
+ * sequences are interleaved, so that (as long as the overall width of
+ * the lower bits does not exceed 56) a single unaligned read retrieves all of them,
+ * and a single jump table, with the entries of all sequences interleaved, is shared
+ * by the upper bits of the sequences. A call to get() thus costs one miss
+ * on the lower bits, one on the jump table and about one for each sequence on the
+ * upper bits.
+ *
+ * Typical uses are indices of blocks of records, such as cumulative record
+ * counts, key offsets and data offsets.
+ *
+ * @tparam N the number of sequences.
+ * @tparam AT a type of memory allocation out of util::AllocType.
+ */
+
+template <size_t N, util::AllocType AT = util::AllocType::MALLOC> class MultiEF {
+	static_assert(N > 0);
+
+	static constexpr uint64_t log2q = 8;
+	static constexpr uint64_t q = 1 << log2q;
+	static constexpr uint64_t q_mask = q - 1;
+	static constexpr uint64_t super_q = 1 << 14;
+	static constexpr uint64_t q_per_super_q = super_q / q;
+	// A superblock contains N absolute positions followed by 32-bit offsets for each block and sequence
+	static constexpr uint64_t super_q_size = N + (q_per_super_q * N + 1) / 2;
+
+	uint64_t n = 0;
+	// If true, the jump table contains an absolute position for each block and sequence
+	bool flat_jump = false;
+	std::array<uint64_t, N> l, lower_offset, lower_mask;
+	uint64_t lower_width = 0;
+	Vector<uint64_t, AT> lower_bits, jump;
+	std::array<Vector<uint64_t, AT>, N> upper_bits;
+
+	__inline static void set(util::Vector<uint64_t, AT> &bits, const uint64_t pos) { bits[pos / 64] |= 1ULL << pos % 64; }
+
+	__inline static void set_bits(util::Vector<uint64_t, AT> &bits, const uint64_t start, const int width, const uint64_t value) {
+		const uint64_t mask = ((UINT64_C(1) << width) - 1) << start % 8;
+		uint64_t t;
+		memcpy(&t, (uint8_t *)&bits + start / 8, 8);
+		t = (t & ~mask) | value << start % 8;
+		memcpy((uint8_t *)&bits + start / 8, &t, 8);
+	}
+
+	__inline uint64_t get_bits(const uint64_t start) const {
+		uint64_t t;
+		memcpy(&t, (uint8_t *)&lower_bits + start / 8, 8);
+		return t >> start % 8;
+	}
+
+	void init_masks() {
+		lower_width = 0;
+		for (size_t k = 0; k < N; k++) {
+			lower_offset[k] = lower_width;
+			lower_width += l[k];
+			lower_mask[k] = (UINT64_C(1) << l[k]) - 1;
+		}
+	}
+
+	__inline size_t jump_size_words() const {
+		if (flat_jump) return ((n + q - 1) / q) * N;
+		return ((n + super_q - 1) / super_q) * super_q_size;
+	}
+
+	__inline uint64_t jump_position(const uint64_t i, const size_t k) const {
+		if (unlikely(flat_jump)) return jump[(i / q) * N + k];
+		const uint64_t jump_super_q = (i / super_q) * super_q_size;
+		return jump[jump_super_q + k] + ((uint32_t *)(&jump + jump_super_q + N))[((i % super_q) / q) * N + k];
+	}
+
+	void build_jump(const size_t k) {
+		const uint64_t words = upper_bits[k].size();
+		for (uint64_t w = 0, c = 0; w < words; w++) {
+			const uint64_t word = upper_bits[k][w];
+			const uint64_t cnt = nu(word);
+			// Ones whose rank is a multiple of q
+			for (uint64_t r = (q - (c & q_mask)) & q_mask; r < cnt && c + r < n; r += q) {
+				const uint64_t rank = c + r, pos = w * 64 + select64(word, r);
+				if (flat_jump) {
+					jump[(rank / q) * N + k] = pos;
+				} else {
+					const uint64_t jump_super_q = (rank / super_q) * super_q_size;
+					if (rank % super_q == 0) jump[jump_super_q + k] = pos;
+					((uint32_t *)(&jump + jump_super_q + N))[((rank % super_q) / q) * N + k] = pos - jump[jump_super_q + k];
+				}
+			}
+			c += cnt;
+		}
+	}
+
+	friend std::ostream &operator<<(std::ostream &os, const MultiEF<N, AT> &ef) {
+		const uint64_t num_sequences = N;
+		os.write((char *)&num_sequences, sizeof(num_sequences));
+		os.write((char *)&ef.n, sizeof(ef.n));
+		os.write((char *)&ef.flat_jump, sizeof(ef.flat_jump));
+		os.write((char *)ef.l.data(), sizeof(ef.l));
+		os << ef.lower_bits;
+		for (const auto &u : ef.upper_bits) os << u;
+		os << ef.jump;
+		return os;
+	}
+
+	friend std::istream &operator>>(std::istream &is, MultiEF<N, AT> &ef) {
+		uint64_t num_sequences;
+		is.read((char *)&num_sequences, sizeof(num_sequences));
+		if (num_sequences != N) {
+			fprintf(stderr, "Serialized number of sequences %d, code number of sequences %d\n", int(num_sequences), int(N));
+			abort();
+		}
+		is.read((char *)&ef.n, sizeof(ef.n));
+		is.read((char *)&ef.flat_jump, sizeof(ef.flat_jump));
+		is.read((char *)ef.l.data(), sizeof(ef.l));
+		ef.init_masks();
+		is >> ef.lower_bits;
+		for (auto &u : ef.upper_bits) is >> u;
+		is >> ef.jump;
+		return is;
+	}
+
+  public:
+	MultiEF() {}
+
+	/** Creates a new instance representing the given sequences.
+	 *
+	 * @param seq N nondecreasing sequences of the same length.
+	 */
+	MultiEF(const std::array<std::vector<uint64_t>, N> &seq) : n(seq[0].size()) {
+		std::array<uint64_t, N> u;
+		for (size_t k = 0; k < N; k++) {
+			assert(seq[k].size() == n);
+			assert(std::is_sorted(seq[k].begin(), seq[k].end()));
+			u[k] = n == 0 ? 1 : seq[k][n - 1] + 1;
+			// At most 56 bits, so that single fields can always be read with one unaligned read
+			l[k] = n == 0 || u[k] / n == 0 ? 0 : std::min(56, lambda(u[k] / n));
+		}
+		init_masks();
+
+		lower_bits.size((n * lower_width + 63) / 64 + 1);
+		for (size_t k = 0; k < N; k++) {
+			const uint64_t upper_size = n + (u[k] >> l[k]) + 1;
+			upper_bits[k].size((upper_size + 63) / 64);
+			// Offsets inside a superblock are bounded by the size of the upper bits
+			if (upper_size >= UINT64_C(1) << 32) flat_jump = true;
+			for (uint64_t i = 0; i < n; i++) {
+				if (l[k] != 0) set_bits(lower_bits, i * lower_width + lower_offset[k], l[k], seq[k][i] & lower_mask[k]);
+				set(upper_bits[k], (seq[k][i] >> l[k]) + i);
+			}
+		}
+
+		jump.size(jump_size_words());
+		for (size_t k = 0; k < N; k++) build_jump(k);
+
+#ifndef NDEBUG
+		for (uint64_t i = 0; i < n; i++) {
+			const auto v = get(i);
+			for (size_t k = 0; k < N; k++) assert(v[k] == seq[k][i]);
+		}
+#endif
+	}
+
+	/** Returns the elements of given index of all sequences.
+	 *
+	 * @param i an index smaller than size().
+	 * @return an array whose k-th element is the i-th element of the k-th sequence.
+	 */
+	std::array<uint64_t, N> get(const uint64_t i) const {
+		assert(i < n);
+		std::array<uint64_t, N> result;
+		const uint64_t pos_lower = i * lower_width;
+		uint64_t lower = 0;
+		if (lower_width <= 56) lower = get_bits(pos_lower);
+
+		for (size_t k = 0; k < N; k++) {
+			const uint64_t jump_pos = jump_position(i, k);
+			uint64_t curr_word = jump_pos / 64;
+			uint64_t window = upper_bits[k][curr_word] & UINT64_C(-1) << jump_pos % 64;
+			uint64_t delta = i & q_mask;
+			for (uint64_t bit_count; (bit_count = nu(window)) <= delta; delta -= bit_count) window = upper_bits[k][++curr_word];
+
+			const uint64_t low = (lower_width <= 56 ? lower >> lower_offset[k] : get_bits(pos_lower + lower_offset[k])) & lower_mask[k];
+			result[k] = (curr_word * 64 + select64(window, delta) - i) << l[k] | low;
+		}
+		return result;
+	}
+
+	/** Returns the number of elements of each sequence. */
+	uint64_t size() const { return n; }
+
+	/** Returns the number of bits used by this structure. */
+	uint64_t bitCount() const {
+		uint64_t bits = (lower_bits.size() + jump.size()) * 64;
+		for (const auto &u : upper_bits) bits += u.size() * 64;
+		return bits;
+	}
+};
+
+} // namespace sux::function
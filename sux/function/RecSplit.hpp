@@ -29,6 +29,7 @@
 #pragma once
 
 #include "../support/SpookyV2.hpp"
+#include "../support/WorkStealing.hpp"
 #include "../util/Vector.hpp"
 #include "DoubleEF.hpp"
 #include "RiceBitVector.hpp"
@@ -37,6 +38,7 @@
 #include <chrono>
 #include <cmath>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <fstream>
 
@@ -51,6 +53,9 @@ static const int MAX_BUCKET_SIZE = 3000;
 static const int MAX_LEAF_SIZE = 24;
 static const int MAX_FANOUT = 32;
 
+// Number of chunks of buckets per thread in parallel constructions.
+static const size_t CHUNKS_PER_THREAD = 256;
+
 #if defined(MORESTATS) && !defined(STATS)
 #define STATS
 #endif
@@ -69,6 +74,7 @@ static uint64_t split_unary, split_fixed, split_unary_golomb, split_fixed_golomb
 static uint64_t max_split_code, min_split_code, sum_split_codes;
 static uint64_t max_bij_code, min_bij_code, sum_bij_codes;
 static uint64_t sum_depths;
+static double split_entropy, bij_entropy;
 static uint64_t time_bij;
 static uint64_t time_split[MAX_LEVEL_TIME];
 #endif
@@ -122,6 +128,35 @@ hash128_t inline spooky(const void *data, const size_t length, const uint64_t se
 	return {h1, h0};
 }
 
+/** Convenience function hashing a list of keys into __hash128_t instances.
+ *
+ * The result is the same as calling spooky() on each key, but short keys
+ * are hashed several at a time using SpookyHash::Hash128Batch().
+ *
+ * @param keys a pointer to the keys.
+ * @param n the number of keys.
+ * @param seed an additional seed.
+ * @param hashes an array of `n` elements that will be filled with the hashes.
+ */
+
+void inline spooky_batch(const string *keys, const size_t n, const uint64_t seed, hash128_t *hashes) {
+	static constexpr size_t BATCH = 64;
+	const void *data[BATCH];
+	size_t length[BATCH];
+	uint64_t h0[BATCH], h1[BATCH];
+
+	for (size_t base = 0; base < n; base += BATCH) {
+		const size_t b = min(BATCH, n - base);
+		for (size_t i = 0; i < b; i++) {
+			data[i] = keys[base + i].c_str();
+			length[i] = keys[base + i].size();
+			h0[i] = h1[i] = seed;
+		}
+		SpookyHash::Hash128Batch(data, length, b, h0, h1);
+		for (size_t i = 0; i < b; i++) hashes[base + i] = {h1[i], h0[i]};
+	}
+}
+
 // Quick replacements for min/max on not-so-large integers.
 
 static constexpr inline uint64_t min(int64_t x, int64_t y) { return y + ((x - y) & ((x - y) >> 63)); }
@@ -272,6 +307,31 @@ template <size_t LEAF_SIZE> static constexpr uint64_t split_golomb_b(const int m
 	return ceil(-log(2 - p) / log1p(-p)); // Golomb modulus
 }
 
+#ifdef MORESTATS
+// Computes the exact probability that a random seed yields a valid splitting (for statistics purposes only)
+
+template <size_t LEAF_SIZE> static double split_probability(const int m) {
+	size_t fanout = 0, unit = 0;
+	SplittingStrategy<LEAF_SIZE>::split_params(m, fanout, unit);
+
+	double log_p = lgamma(m + 1);
+	for (size_t i = 0; i < fanout; ++i) {
+		const int k = i < fanout - 1 ? unit : m - unit * (fanout - 1);
+		log_p += k * log((double)k / m) - lgamma(k + 1);
+	}
+	return exp(log_p);
+}
+
+// Computes the exact probability that a random seed yields a bijection on a leaf (for statistics purposes only)
+
+static double bij_probability(const int m) { return exp(lgamma(m + 1) - m * log(m)); }
+
+// Entropy, in bits, of a geometric distribution: a lower bound on the expected
+// length of any code for the seeds of nodes whose trials succeed with probability p.
+
+static double geometric_entropy(const double p) { return p >= 1 ? 0 : (-p * log2(p) - (1 - p) * log2(1 - p)) / p; }
+#endif
+
 // Computes the point at which one should stop to test whether
 // bijection extraction failed (around the square root of the leaf size).
 
@@ -309,6 +369,17 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 	static constexpr array<uint32_t, MAX_BUCKET_SIZE> memo = fill_golomb_rice<LEAF_SIZE>();
 	static constexpr array<uint8_t, MAX_LEAF_SIZE> bij_midstop = fill_bij_midstop();
 
+	// Batch evaluation: smaller batches are not sorted, and the digit size of the radix sort
+	static constexpr size_t MIN_SORTED_BATCH = 1 << 12;
+	static constexpr int RADIX_BITS = 11;
+	// Number of hashes whose memory accesses are overlapped in batch evaluation
+	static constexpr size_t BATCH_GROUP = 32;
+
+	struct BatchEntry {
+		uint64_t first, second;
+		size_t index;
+	};
+
 	size_t bucket_size;
 	size_t nbuckets;
 	size_t keys_count;
@@ -326,15 +397,15 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 	 * @param bucket_size the desired bucket size; typical sizes go from
 	 * 100 to 2000, with smaller buckets giving slightly larger but faster
 	 * functions.
+	 * @param num_threads the number of threads used for construction; the
+	 * resulting function does not depend on it.
 	 */
-	RecSplit(const vector<string> &keys, const size_t bucket_size) {
+	RecSplit(const vector<string> &keys, const size_t bucket_size, const size_t num_threads = 1) {
 		this->bucket_size = bucket_size;
 		this->keys_count = keys.size();
 		hash128_t *h = (hash128_t *)malloc(this->keys_count * sizeof(hash128_t));
-		for (size_t i = 0; i < this->keys_count; ++i) {
-			h[i] = first_hash(keys[i].c_str(), keys[i].size());
-		}
-		hash_gen(h);
+		spooky_batch(keys.data(), this->keys_count, 0, h);
+		hash_gen(h, num_threads);
 		free(h);
 	}
 
@@ -347,11 +418,13 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 	 * @param bucket_size the desired bucket size; typical sizes go from
 	 * 100 to 2000, with smaller buckets giving slightly larger but faster
 	 * functions.
+	 * @param num_threads the number of threads used for construction; the
+	 * resulting function does not depend on it.
 	 */
-	RecSplit(vector<hash128_t> &keys, const size_t bucket_size) {
+	RecSplit(vector<hash128_t> &keys, const size_t bucket_size, const size_t num_threads = 1) {
 		this->bucket_size = bucket_size;
 		this->keys_count = keys.size();
-		hash_gen(&keys[0]);
+		hash_gen(&keys[0], num_threads);
 	}
 
 	/** Builds a RecSplit instance using a list of keys returned by a stream and bucket size.
@@ -360,13 +433,14 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 	 *
 	 * @param input an open input stream returning a list of keys, one per line.
 	 * @param bucket_size the desired bucket size.
+	 * @param num_threads the number of threads used for construction.
 	 */
-	RecSplit(ifstream& input, const size_t bucket_size) {
+	RecSplit(ifstream& input, const size_t bucket_size, const size_t num_threads = 1) {
 		this->bucket_size = bucket_size;
 		vector<hash128_t> h;
 		for(string key; getline(input, key);) h.push_back(first_hash(key.c_str(), key.size()));
 		this->keys_count = h.size();
-		hash_gen(&h[0]);
+		hash_gen(&h[0], num_threads);
 	}
 
 	/** Returns the value associated with the given 128-bit hash.
@@ -379,9 +453,12 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		const size_t bucket = hash128_to_bucket(hash);
 		uint64_t cum_keys, cum_keys_next, bit_pos;
 		ef.get(bucket, cum_keys, cum_keys_next, bit_pos);
+		return descend(hash, cum_keys, cum_keys_next - cum_keys, bit_pos);
+	}
 
-		// Number of keys in this bucket
-		size_t m = cum_keys_next - cum_keys;
+  private:
+	// Finds the value of a hash in its bucket, given the first value, the size and the descriptor position of the bucket.
+	size_t descend(const hash128_t &hash, uint64_t cum_keys, size_t m, const uint64_t bit_pos) {
 		auto reader = descriptors.reader();
 		reader.readReset(bit_pos, skip_bits(m));
 		int level = 0;
@@ -426,6 +503,28 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		return cum_keys + remap16(remix(hash.second + b + start_seed[level]), m);
 	}
 
+	// Evaluates a batch of hashes in groups: bucket offsets are retrieved using the
+	// prefetching batch get() of DoubleEF, and descriptors are prefetched before descending.
+	template <typename H> void evaluate(const H *hashes, const size_t n, size_t *values) {
+		uint64_t bucket[BATCH_GROUP], cum_keys[BATCH_GROUP], cum_keys_next[BATCH_GROUP], bit_pos[BATCH_GROUP];
+		for (size_t base = 0; base < n; base += BATCH_GROUP) {
+			const size_t b = std::min(BATCH_GROUP, n - base);
+			for (size_t j = 0; j < b; j++) bucket[j] = remap128(hashes[base + j].first, nbuckets);
+			ef.get(bucket, b, cum_keys, cum_keys_next, bit_pos);
+			for (size_t j = 0; j < b; j++) descriptors.prefetch(bit_pos[j], skip_bits(cum_keys_next[j] - cum_keys[j]));
+			for (size_t j = 0; j < b; j++) {
+				const H &h = hashes[base + j];
+				const size_t v = descend(hash128_t(h.first, h.second), cum_keys[j], cum_keys_next[j] - cum_keys[j], bit_pos[j]);
+				if constexpr (is_same_v<H, BatchEntry>)
+					values[h.index] = v;
+				else
+					values[base + j] = v;
+			}
+		}
+	}
+
+  public:
+
 	/** Returns the value associated with the given key.
 	 *
 	 * @param key a key.
@@ -433,6 +532,57 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 	 */
 	size_t operator()(const string &key) { return operator()(first_hash(key.c_str(), key.size())); }
 
+	/** Stores in an array the values associated with a batch of 128-bit hashes.
+	 *
+	 * If `bucket_order` is true, the hashes are first sorted by bucket using a radix
+	 * sort, and then evaluated in bucket order; results are scattered back in the
+	 * order of `hashes`. In this way, accesses to the bucket index and to the
+	 * descriptors become mostly sequential, at the price of an additional 48 bytes
+	 * per key (an entry and a radix-sort buffer of 24 bytes each). In both cases,
+	 * memory accesses of several hashes are overlapped using prefetching, so sorting
+	 * (which is thus off by default) pays off only for very large batches (e.g., millions of keys)
+	 * on functions much larger than the cache.
+	 *
+	 * @param hashes an array of `n` 128-bit hashes.
+	 * @param n the number of hashes.
+	 * @param values an array of `n` elements that will be filled with the associated values.
+	 * @param bucket_order whether to evaluate the hashes in bucket order.
+	 */
+	void operator()(const hash128_t *hashes, const size_t n, size_t *values, const bool bucket_order = false) {
+		if (!bucket_order || n < MIN_SORTED_BATCH) {
+			evaluate(hashes, n, values);
+			return;
+		}
+
+		vector<BatchEntry> entry(n), temp(n);
+		for (size_t i = 0; i < n; i++) entry[i] = {hashes[i].first, hashes[i].second, i};
+
+		// LSD radix sort on the bucket index
+		static constexpr size_t RADIX = 1 << RADIX_BITS;
+		const int bits = lambda(nbuckets) + 1;
+		for (int shift = 0; shift < bits; shift += RADIX_BITS) {
+			size_t count[RADIX + 1] = {0};
+			for (const auto &e : entry) count[(remap128(e.first, nbuckets) >> shift & (RADIX - 1)) + 1]++;
+			for (size_t d = 0; d < RADIX; d++) count[d + 1] += count[d];
+			for (const auto &e : entry) temp[count[remap128(e.first, nbuckets) >> shift & (RADIX - 1)]++] = e;
+			entry.swap(temp);
+		}
+
+		evaluate(entry.data(), n, values);
+	}
+
+	/** Stores in an array the values associated with a batch of keys.
+	 *
+	 * @param keys a vector of keys.
+	 * @param values an array of `keys.size()` elements that will be filled with the associated values.
+	 * @param bucket_order whether to evaluate the keys in bucket order (see operator()(const hash128_t *, size_t, size_t *, bool)).
+	 */
+	void operator()(const vector<string> &keys, size_t *values, const bool bucket_order = false) {
+		vector<hash128_t> h(keys.size(), hash128_t(0, 0));
+		spooky_batch(keys.data(), keys.size(), 0, h.data());
+		operator()(h.data(), h.size(), values, bucket_order);
+	}
+
 	/** Returns the number of keys used to build this RecSplit instance. */
 	inline size_t size() { return this->keys_count; }
 
@@ -447,7 +597,7 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		recSplit(bucket, temp, 0, bucket.size(), builder, unary, 0);
 	}
 
-	void recSplit(vector<uint64_t> &bucket, vector<uint64_t> &temp, size_t start, size_t end, typename RiceBitVector<AT>::Builder &builder, vector<uint32_t> &unary, const int level) {
+	SUX_MULTIVERSION void recSplit(vector<uint64_t> &bucket, vector<uint64_t> &temp, size_t start, size_t end, typename RiceBitVector<AT>::Builder &builder, vector<uint32_t> &unary, const int level) {
 		const auto m = end - start;
 		assert(m > 1);
 		uint64_t x = start_seed[level];
@@ -509,6 +659,7 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 			auto log2b = lambda(b);
 			bij_unary_golomb += x / b + 1;
 			bij_fixed_golomb += x % b < ((1 << log2b + 1) - b) ? log2b : log2b + 1;
+			bij_entropy += geometric_entropy(bij_probability(m));
 #endif
 		} else {
 #ifdef MORESTATS
@@ -658,11 +809,12 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 			auto log2b = lambda(b);
 			split_unary_golomb += x / b + 1;
 			split_fixed_golomb += x % b < ((1ULL << log2b + 1) - b) ? log2b : log2b + 1;
+			split_entropy += geometric_entropy(split_probability<LEAF_SIZE>(m));
 #endif
 		}
 	}
 
-	void hash_gen(hash128_t *hashes) {
+	void hash_gen(hash128_t *hashes, size_t num_threads) {
 #ifdef MORESTATS
 		time_bij = 0;
 		memset(time_split, 0, sizeof time_split);
@@ -673,6 +825,7 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		min_bij_code = 1UL << 63;
 		max_bij_code = sum_bij_codes = 0;
 		sum_depths = 0;
+		split_entropy = bij_entropy = 0;
 		size_t minsize = keys_count, maxsize = 0;
 		double ub_split_bits = 0, ub_bij_bits = 0;
 		double ub_split_evals = 0, ub_bij_evals = 0;
@@ -689,35 +842,75 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		auto bucket_pos_acc = vector<int64_t>(nbuckets + 1);
 
 		sort(hashes, hashes + keys_count, [this](const hash128_t &a, const hash128_t &b) { return hash128_to_bucket(a) < hash128_to_bucket(b); });
-		typename RiceBitVector<AT>::Builder builder;
 
 		bucket_size_acc[0] = bucket_pos_acc[0] = 0;
 		for (size_t i = 0, last = 0; i < nbuckets; i++) {
+			for (; last < keys_count && hash128_to_bucket(hashes[last]) == i; last++)
+				;
+			bucket_size_acc[i + 1] = last;
+		}
+
+#ifdef MORESTATS
+		num_threads = 1; // Statistics are gathered in global variables
+#endif
+		// Buckets are split into chunks of consecutive buckets, each one with its own
+		// builder; chunks are fine grained, so that threads can steal work from
+		// threads stuck on expensive buckets. The builders are then concatenated, so the
+		// result does not depend on the number of threads.
+		const size_t num_chunks = num_threads <= 1 ? 1 : min(nbuckets, num_threads * CHUNKS_PER_THREAD);
+		num_threads = max(1, min(num_threads, num_chunks));
+		vector<typename RiceBitVector<AT>::Builder> chunk_builder(num_chunks);
+#ifdef STATS
+		vector<uint64_t> bucket_time(nbuckets), thread_time(num_threads);
+#endif
+
+		[[maybe_unused]] const size_t steals = work_stealing(num_chunks, num_threads, [&](const size_t c, [[maybe_unused]] const size_t t) {
+			auto &builder = chunk_builder[c];
 			vector<uint64_t> bucket;
-			for (; last < keys_count && hash128_to_bucket(hashes[last]) == i; last++) bucket.push_back(hashes[last].second);
-
-			const size_t s = bucket.size();
-			bucket_size_acc[i + 1] = bucket_size_acc[i] + s;
-			if (bucket.size() > 1) {
-				vector<uint32_t> unary;
-				recSplit(bucket, builder, unary);
-				builder.appendUnaryAll(unary);
-			}
-			bucket_pos_acc[i + 1] = builder.getBits();
+			vector<uint32_t> unary;
+			for (size_t i = c * nbuckets / num_chunks; i < (c + 1) * nbuckets / num_chunks; i++) {
+#ifdef STATS
+				auto start_time = high_resolution_clock::now();
+#endif
+				bucket.clear();
+				for (int64_t j = bucket_size_acc[i]; j < bucket_size_acc[i + 1]; j++) bucket.push_back(hashes[j].second);
+
+				const size_t s = bucket.size();
+				if (s > 1) {
+					unary.clear();
+					recSplit(bucket, builder, unary);
+					builder.appendUnaryAll(unary);
+				}
+				// Relative to the chunk; fixed below
+				bucket_pos_acc[i + 1] = builder.getBits();
+#ifdef STATS
+				bucket_time[i] = duration_cast<nanoseconds>(high_resolution_clock::now() - start_time).count();
+				thread_time[t] += bucket_time[i];
+#endif
 #ifdef MORESTATS
-			auto upper_leaves = (s + _leaf - 1) / _leaf;
-			auto upper_height = ceil(log(upper_leaves) / log(2)); // TODO: check
-			auto upper_s = _leaf * pow(2, upper_height);
-			ub_split_bits += (double)upper_s / (_leaf * 2) * log2(2 * M_PI * _leaf) - .5 * log2(2 * M_PI * upper_s);
-			ub_bij_bits += upper_leaves * _leaf * (log2e - .5 / _leaf * log2(2 * M_PI * _leaf));
-			ub_split_evals += 4 * upper_s * sqrt(pow(2 * M_PI * upper_s, 2 - 1) / pow(2, 2));
-			minsize = min(minsize, s);
-			maxsize = max(maxsize, s);
+				auto upper_leaves = (s + _leaf - 1) / _leaf;
+				auto upper_height = ceil(log(upper_leaves) / log(2)); // TODO: check
+				auto upper_s = _leaf * pow(2, upper_height);
+				ub_split_bits += (double)upper_s / (_leaf * 2) * log2(2 * M_PI * _leaf) - .5 * log2(2 * M_PI * upper_s);
+				ub_bij_bits += upper_leaves * _leaf * (log2e - .5 / _leaf * log2(2 * M_PI * _leaf));
+				ub_split_evals += 4 * upper_s * sqrt(pow(2 * M_PI * upper_s, 2 - 1) / pow(2, 2));
+				minsize = min(minsize, s);
+				maxsize = max(maxsize, s);
 #endif
+			}
+		});
+
+		typename RiceBitVector<AT>::Builder builder = std::move(chunk_builder[0]);
+		for (size_t c = 1; c < num_chunks; c++) {
+			const int64_t base = builder.getBits();
+			builder.append(chunk_builder[c]);
+			chunk_builder[c] = typename RiceBitVector<AT>::Builder(0);
+			for (size_t i = c * nbuckets / num_chunks; i < (c + 1) * nbuckets / num_chunks; i++) bucket_pos_acc[i + 1] += base;
 		}
+
 		builder.appendFixed(1, 1); // Sentinel (avoids checking for parts of size 1)
 		descriptors = builder.build();
-		ef = DoubleEF<AT>(vector<uint64_t>(bucket_size_acc.begin(), bucket_size_acc.end()), vector<uint64_t>(bucket_pos_acc.begin(), bucket_pos_acc.end()));
+		ef = DoubleEF<AT>(vector<uint64_t>(bucket_size_acc.begin(), bucket_size_acc.end()), vector<uint64_t>(bucket_pos_acc.begin(), bucket_pos_acc.end()), num_threads);
 
 #ifdef STATS
 		// Evaluation purposes only
@@ -730,6 +923,18 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		printf("Elias-Fano cumul bits:   %f bits/key\n", ef_bits);
 		printf("Rice-Golomb descriptors: %f bits/key\n", rice_desc);
 		printf("Total bits:              %f bits/key\n", ef_sizes + ef_bits + rice_desc);
+
+		// Per-bucket construction costs: a heavy tail is what makes work stealing necessary
+		sort(bucket_time.begin(), bucket_time.end());
+		uint64_t tot_bucket_time = 0;
+		for (const auto &t : bucket_time) tot_bucket_time += t;
+		const double mean_bucket_time = (double)tot_bucket_time / nbuckets;
+		const auto [min_thread_time, max_thread_time] = minmax_element(thread_time.begin(), thread_time.end());
+		printf("Bucket time (mean):      %.3f us\n", mean_bucket_time * 1E-3);
+		printf("Bucket time (p99):       %.3f us\n", bucket_time[nbuckets - 1 - nbuckets / 100] * 1E-3);
+		printf("Bucket time (max):       %.3f us (%.1fx mean)\n", bucket_time[nbuckets - 1] * 1E-3, bucket_time[nbuckets - 1] / mean_bucket_time);
+		printf("Threads:                 %zu (%zu chunks, %zu steals)\n", num_threads, num_chunks, steals);
+		printf("Thread busy time:        %.3f-%.3f ms\n", *min_thread_time * 1E-6, *max_thread_time * 1E-6);
 #endif
 #ifdef MORESTATS
 
@@ -795,12 +1000,19 @@ template <size_t LEAF_SIZE, util::AllocType AT = util::AllocType::MALLOC> class
 		printf("Total bits per split (Golomb): %10.5f\n", (double)(split_unary_golomb + split_fixed_golomb) / split_count);
 		printf("Total bits per key (Golomb):   %10.5f\n", (double)(bij_unary_golomb + bij_fixed_golomb + split_unary_golomb + split_fixed_golomb) / keys_count);
 
+		printf("\n");
+		printf("Entropy bits per bij:   %10.5f\n", bij_entropy / tot_bij_count);
+		printf("Entropy bits per split: %10.5f\n", split_entropy / split_count);
+		printf("Entropy bits per key:   %10.5f\n", (bij_entropy + split_entropy) / keys_count);
+
 		printf("\n");
 
 		printf("Total split bits        %16.3f\n", (double)split_fixed + split_unary);
 		printf("Upper bound split bits: %16.3f\n", ub_split_bits);
 		printf("Total bij bits:         %16.3f\n", (double)bij_fixed + bij_unary);
-		printf("Upper bound bij bits:   %16.3f\n\n", ub_bij_bits);
+		printf("Upper bound bij bits:   %16.3f\n", ub_bij_bits);
+		printf("Entropy split bits:     %16.3f\n", split_entropy);
+		printf("Entropy bij bits:       %16.3f\n\n", bij_entropy);
 #endif
 	}
 
@@ -92,6 +92,30 @@ template <util::AllocType AT = util::AllocType::MALLOC> class RiceBitVector {
 			}
 		}
 
+		/** Appends the bits of another builder.
+		 *
+		 * Since the contents of a builder are self-delimiting only within a bucket, this
+		 * method makes it possible to build buckets independently and concatenate them later.
+		 */
+		void append(const Builder &other) {
+			const size_t words = (other.bit_count + 63) / 64;
+			if (words == 0) return;
+			const int shift = bit_count & 63;
+			data.resize(max((((bit_count + other.bit_count + 7) / 8) + 7 + 7) / 8, bit_count / 64 + words + 1));
+
+			uint64_t *append_ptr = &data + bit_count / 64;
+			const uint64_t *other_ptr = &other.data;
+			if (shift == 0) {
+				for (size_t i = 0; i < words; i++) append_ptr[i] = other_ptr[i];
+			} else {
+				for (size_t i = 0; i < words; i++) {
+					append_ptr[i] |= other_ptr[i] << shift;
+					append_ptr[i + 1] = other_ptr[i] >> (64 - shift);
+				}
+			}
+			bit_count += other.bit_count;
+		}
+
 		uint64_t getBits() { return bit_count; }
 
 		RiceBitVector<AT> build() {
@@ -185,6 +209,16 @@ template <util::AllocType AT = util::AllocType::MALLOC> class RiceBitVector {
 	};
 
 	Reader reader() { return Reader(data); }
+
+	/** Prefetches the data that a reader reset at the given position will access first.
+	 *
+	 * @param bit_pos the position of the fixed part of a bucket.
+	 * @param unary_offset the offset of the unary part from `bit_pos`.
+	 */
+	void prefetch(const size_t bit_pos, const size_t unary_offset) const {
+		__builtin_prefetch((uint8_t *)&data + bit_pos / 8);
+		__builtin_prefetch((uint8_t *)&data + (bit_pos + unary_offset) / 8);
+	}
 };
 
 } // namespace sux::function
@@ -0,0 +1,249 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+
+namespace sux {
+
+using namespace std;
+
+/** Bulk population counts.
+ *
+ * These kernels are used by the constructors of the static rank/select
+ * structures. With AVX-512 VPOPCNTDQ they count eight words per instruction;
+ * with AVX2 they use the Harley&ndash;Seal carry-save adder tree over
+ * 256-bit vectors; otherwise, they use independent accumulators over
+ * scalar popcounts, multiversioned so that portable builds use the POPCNT
+ * instruction when available.
+ */
+
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512F__)
+// GCC reports spurious uninitialized values inside some AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define SUX_POPCOUNT_AVX512
+
+inline uint64_t popcount_kernel(const uint64_t *const words, const size_t n) {
+	__m512i c0 = _mm512_setzero_si512(), c1 = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		c0 = _mm512_add_epi64(c0, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+		c1 = _mm512_add_epi64(c1, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i + 8)));
+	}
+	if (i + 8 <= n) {
+		c0 = _mm512_add_epi64(c0, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+		i += 8;
+	}
+	if (i < n) c1 = _mm512_add_epi64(c1, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64((__mmask8)((1U << (n - i)) - 1), words + i)));
+	return _mm512_reduce_add_epi64(_mm512_add_epi64(c0, c1));
+}
+
+#elif defined(__AVX2__)
+
+// Population count of the bytes of a vector, summed in each 64-bit lane
+inline __m256i popcount256(const __m256i v) {
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_mask = _mm256_set1_epi8(0x0f);
+	const __m256i lo = _mm256_and_si256(v, low_mask);
+	const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+	const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+	return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+// Carry-save adder: h:l = a + b + c
+inline void csa256(__m256i &h, __m256i &l, const __m256i a, const __m256i b, const __m256i c) {
+	const __m256i u = _mm256_xor_si256(a, b);
+	h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+	l = _mm256_xor_si256(u, c);
+}
+
+inline uint64_t popcount_kernel(const uint64_t *const words, const size_t n) {
+	const __m256i *const d = (const __m256i *)words;
+	const size_t size = n / 4;
+	__m256i total = _mm256_setzero_si256(), ones = _mm256_setzero_si256(), twos = _mm256_setzero_si256(), fours = _mm256_setzero_si256(), eights = _mm256_setzero_si256();
+	__m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+	size_t i = 0;
+
+	for (; i + 16 <= size; i += 16) {
+		csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i), _mm256_loadu_si256(d + i + 1));
+		csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 2), _mm256_loadu_si256(d + i + 3));
+		csa256(fours_a, twos, twos, twos_a, twos_b);
+		csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 4), _mm256_loadu_si256(d + i + 5));
+		csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 6), _mm256_loadu_si256(d + i + 7));
+		csa256(fours_b, twos, twos, twos_a, twos_b);
+		csa256(eights_a, fours, fours, fours_a, fours_b);
+		csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 8), _mm256_loadu_si256(d + i + 9));
+		csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 10), _mm256_loadu_si256(d + i + 11));
+		csa256(fours_a, twos, twos, twos_a, twos_b);
+		csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 12), _mm256_loadu_si256(d + i + 13));
+		csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 14), _mm256_loadu_si256(d + i + 15));
+		csa256(fours_b, twos, twos, twos_a, twos_b);
+		csa256(eights_b, fours, fours, fours_a, fours_b);
+		csa256(sixteens, eights, eights, eights_a, eights_b);
+		total = _mm256_add_epi64(total, popcount256(sixteens));
+	}
+
+	total = _mm256_slli_epi64(total, 4);
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+	total = _mm256_add_epi64(total, popcount256(ones));
+	for (; i < size; i++) total = _mm256_add_epi64(total, popcount256(_mm256_loadu_si256(d + i)));
+
+	uint64_t c = (uint64_t)_mm256_extract_epi64(total, 0) + (uint64_t)_mm256_extract_epi64(total, 1) + (uint64_t)_mm256_extract_epi64(total, 2) + (uint64_t)_mm256_extract_epi64(total, 3);
+	for (i *= 4; i < n; i++) c += nu(words[i]);
+	return c;
+}
+
+#else
+
+SUX_MULTIVERSION inline uint64_t popcount_kernel(const uint64_t *const words, const size_t n) {
+	uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		c0 += nu(words[i]);
+		c1 += nu(words[i + 1]);
+		c2 += nu(words[i + 2]);
+		c3 += nu(words[i + 3]);
+	}
+	for (; i < n; i++) c0 += nu(words[i]);
+	return c0 + c1 + c2 + c3;
+}
+
+#endif
+
+/** Returns the number of ones in an array of words.
+ *
+ * @param words an array of words.
+ * @param n the number of words.
+ * @return the number of ones in the first `n` words of `words`.
+ */
+inline uint64_t popcount(const uint64_t *const words, const size_t n) { return popcount_kernel(words, n); }
+
+/** Computes the number of ones in consecutive blocks of words.
+ *
+ * @param words an array of words.
+ * @param n the number of words.
+ * @param block_words the number of words in a block; the last block might be shorter.
+ * @param out an array of at least &lceil;`n` / `block_words`&rceil; elements that will be
+ * filled with the number of ones in each block.
+ * @return the number of ones in the first `n` words of `words`.
+ */
+SUX_MULTIVERSION inline uint64_t popcount_blocks(const uint64_t *const words, const size_t n, const size_t block_words, uint64_t *const out) {
+	uint64_t c = 0;
+	if (block_words == 1) {
+		for (size_t i = 0; i < n; i++) c += out[i] = nu(words[i]);
+		return c;
+	}
+	for (size_t i = 0, b = 0; i < n; i += block_words, b++) c += out[b] = popcount_kernel(words + i, min(block_words, n - i));
+	return c;
+}
+
+/** Fills the counts of a Rank9 structure.
+ *
+ * For each block of eight words, two words are written: the number of ones
+ * before the block, and the number of ones before each of the words
+ * one to seven of the block, relative to the start of the block, in
+ * seven 9-bit fields. Fields past the end of the bit vector repeat the
+ * count of the whole last block.
+ *
+ * @param bits a bit vector of 64-bit words.
+ * @param num_words the number of words in `bits`.
+ * @param counts an array of at least 2&lceil;`num_words` / 8&rceil; elements.
+ * @param num_ones the number of ones preceding `bits`, which will be added to first-level counts
+ * (useful to fill the counts of a bit vector in chunks).
+ * @return `num_ones` plus the number of ones in `bits`.
+ */
+SUX_MULTIVERSION inline uint64_t rank9_counts(const uint64_t *const bits, const size_t num_words, uint64_t *const counts, uint64_t num_ones = 0) {
+	size_t i = 0, pos = 0;
+
+#ifdef SUX_POPCOUNT_AVX512
+	const __m512i zero = _mm512_setzero_si512();
+	// Shifts placing the inclusive prefix count of word j in the field of word j + 1
+	const __m512i shift = _mm512_setr_epi64(0, 9, 18, 27, 36, 45, 54, 0);
+	for (; i + 8 <= num_words; i += 8, pos += 2) {
+		__m512i p = _mm512_popcnt_epi64(_mm512_loadu_si512(bits + i));
+		p = _mm512_add_epi64(p, _mm512_alignr_epi64(p, zero, 7));
+		p = _mm512_add_epi64(p, _mm512_alignr_epi64(p, zero, 6));
+		p = _mm512_add_epi64(p, _mm512_alignr_epi64(p, zero, 4));
+		counts[pos] = num_ones;
+		counts[pos + 1] = _mm512_mask_reduce_or_epi64(0x7F, _mm512_sllv_epi64(p, shift));
+		num_ones += _mm_extract_epi64(_mm512_extracti32x4_epi32(p, 3), 1);
+	}
+#endif
+
+	for (; i < num_words; i += 8, pos += 2) {
+		counts[pos] = num_ones;
+		uint64_t sub = 0;
+		num_ones += nu(bits[i]);
+		for (int j = 1; j < 8; j++) {
+			sub |= (num_ones - counts[pos]) << 9 * (j - 1);
+			if (i + j < num_words) num_ones += nu(bits[i + j]);
+		}
+		counts[pos + 1] = sub;
+	}
+
+	return num_ones;
+}
+
+/** Locates the ones (or zeros) of a bit vector whose rank is a multiple of a power of two.
+ *
+ * The bit vector is scanned a word at a time, and ones (zeros) are located
+ * within a word using select64(), so the cost is proportional to the number
+ * of words scanned plus the number of ones (zeros) located.
+ *
+ * @tparam ZERO whether to locate zeros rather than ones.
+ * @param bits a bit vector of 64-bit words.
+ * @param word the index of the word from which the scan starts.
+ * @param rank the number of ones (zeros) before `word`.
+ * @param from the smallest rank to locate; it must not be smaller than `rank`.
+ * @param to the largest rank to locate, exclusive; the ones (zeros) of smaller rank must exist.
+ * @param log2_step the base-2 logarithm of the step between located ranks.
+ * @param f a function called as `f(r, pos)` for each located one (zero), where `r` is its rank
+ * and `pos` its position, in increasing order.
+ */
+template <bool ZERO, typename F> inline void select_every(const uint64_t *const bits, uint64_t word, uint64_t rank, const uint64_t from, const uint64_t to, const int log2_step, F &&f) {
+	assert(from >= rank);
+	const uint64_t step = UINT64_C(1) << log2_step;
+	for (uint64_t target = (from + step - 1) & -step; target < to; word++) {
+		const uint64_t w = ZERO ? ~bits[word] : bits[word];
+		const uint64_t c = nu(w);
+		for (; target < rank + c && target < to; target += step) f(target, word * 64 + select64(w, target - rank));
+		rank += c;
+	}
+}
+
+#ifdef SUX_POPCOUNT_AVX512
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace sux
@@ -26,6 +26,8 @@
 // slower than MD5.
 //
 
+#pragma once
+
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -290,6 +292,69 @@ class SpookyHash {
 		h1 += h0;
 	}
 
+	//
+	// Add the last 0..15 bytes of a short message to c and d.
+	//
+	static inline void ShortTail(const uint8_t *p8, size_t remainder, uint64_t &c, uint64_t &d) {
+		uint64_t w64;
+		uint32_t w32;
+		switch (remainder) {
+		case 15:
+			d += ((uint64_t)p8[14]) << 48;
+			[[fallthrough]];
+		case 14:
+			d += ((uint64_t)p8[13]) << 40;
+			[[fallthrough]];
+		case 13:
+			d += ((uint64_t)p8[12]) << 32;
+			[[fallthrough]];
+		case 12:
+			memcpy(&w32, p8 + 8, 4);
+			memcpy(&w64, p8, 8);
+			d += w32;
+			c += w64;
+			break;
+		case 11:
+			d += ((uint64_t)p8[10]) << 16;
+			[[fallthrough]];
+		case 10:
+			d += ((uint64_t)p8[9]) << 8;
+			[[fallthrough]];
+		case 9:
+			d += (uint64_t)p8[8];
+			[[fallthrough]];
+		case 8:
+			memcpy(&w64, p8, 8);
+			c += w64;
+			break;
+		case 7:
+			c += ((uint64_t)p8[6]) << 48;
+			[[fallthrough]];
+		case 6:
+			c += ((uint64_t)p8[5]) << 40;
+			[[fallthrough]];
+		case 5:
+			c += ((uint64_t)p8[4]) << 32;
+			[[fallthrough]];
+		case 4:
+			memcpy(&w32, p8, 4);
+			c += w32;
+			break;
+		case 3:
+			c += ((uint64_t)p8[2]) << 16;
+			[[fallthrough]];
+		case 2:
+			c += ((uint64_t)p8[1]) << 8;
+			[[fallthrough]];
+		case 1:
+			c += (uint64_t)p8[0];
+			break;
+		case 0:
+			c += sc_const;
+			d += sc_const;
+		}
+	}
+
   private:
 	// number of uint64_t's in internal state
 	static const size_t sc_numVars = 12;
@@ -366,46 +431,7 @@ class SpookyHash {
 
 		// Handle the last 0..15 bytes, and its length
 		d += ((uint64_t)length) << 56;
-		switch (remainder) {
-		case 15:
-			d += ((uint64_t)u.p8[14]) << 48;
-		case 14:
-			d += ((uint64_t)u.p8[13]) << 40;
-		case 13:
-			d += ((uint64_t)u.p8[12]) << 32;
-		case 12:
-			d += u.p32[2];
-			c += u.p64[0];
-			break;
-		case 11:
-			d += ((uint64_t)u.p8[10]) << 16;
-		case 10:
-			d += ((uint64_t)u.p8[9]) << 8;
-		case 9:
-			d += (uint64_t)u.p8[8];
-		case 8:
-			c += u.p64[0];
-			break;
-		case 7:
-			c += ((uint64_t)u.p8[6]) << 48;
-		case 6:
-			c += ((uint64_t)u.p8[5]) << 40;
-		case 5:
-			c += ((uint64_t)u.p8[4]) << 32;
-		case 4:
-			c += u.p32[0];
-			break;
-		case 3:
-			c += ((uint64_t)u.p8[2]) << 16;
-		case 2:
-			c += ((uint64_t)u.p8[1]) << 8;
-		case 1:
-			c += (uint64_t)u.p8[0];
-			break;
-		case 0:
-			c += sc_const;
-			d += sc_const;
-		}
+		ShortTail(u.p8, remainder, c, d);
 		ShortEnd(a, b, c, d);
 		*hash1 = a;
 		*hash2 = b;
@@ -486,6 +512,90 @@ class SpookyHash {
 		*hash2 = h1;
 	}
 
+	/** Hashes a batch of messages to 128 bits.
+	 *
+	 * The result is the same as calling Hash128() on each message, but
+	 * short messages are hashed in groups of `LANES`, keeping the state of
+	 * each message in a separate lane so that the compiler can map the
+	 * mixing rounds to SIMD instructions. Messages of different lengths
+	 * can be mixed freely; long messages are handed to Hash128().
+	 *
+	 * @tparam LANES the number of messages hashed in parallel (4 or 8).
+	 * @param data an array of `n` pointers to the messages.
+	 * @param length an array of `n` message lengths, in bytes.
+	 * @param n the number of messages.
+	 * @param hash1 an array of `n` elements: in seeds 1, out hashes 1.
+	 * @param hash2 an array of `n` elements: in seeds 2, out hashes 2.
+	 */
+	template <size_t LANES = 4> static void Hash128Batch(const void *const *data, const size_t *length, size_t n, uint64_t *hash1, uint64_t *hash2) {
+		static_assert(LANES == 4 || LANES == 8, "Only 4 or 8 lanes are supported");
+
+		for (size_t base = 0; base < n; base += LANES) {
+			const size_t lanes = n - base < LANES ? n - base : LANES;
+			uint64_t a[LANES], b[LANES], c[LANES], d[LANES];
+			size_t steps[LANES];
+			size_t max_steps = 0;
+
+			// Lanes past the end and long messages are idle (zero steps)
+			for (size_t l = 0; l < LANES; l++) {
+				const size_t len = l < lanes ? length[base + l] : 0;
+				a[l] = l < lanes ? hash1[base + l] : 0;
+				b[l] = l < lanes ? hash2[base + l] : 0;
+				c[l] = d[l] = sc_const;
+				// Complete sets of 32 bytes, plus possibly one set of 16 bytes
+				steps[l] = l < lanes && len < sc_bufSize && len > 15 ? len / 32 + (len % 32 >= 16) : 0;
+				if (steps[l] > max_steps) max_steps = steps[l];
+			}
+
+			for (size_t s = 0; s < max_steps; s++) {
+				uint64_t w0[LANES], w1[LANES], w2[LANES], w3[LANES], active[LANES];
+				for (size_t l = 0; l < LANES; l++) {
+					w0[l] = w1[l] = w2[l] = w3[l] = active[l] = 0;
+					if (s < steps[l]) {
+						const uint8_t *p8 = (const uint8_t *)data[base + l] + s * 32;
+						memcpy(&w0[l], p8, 8);
+						memcpy(&w1[l], p8 + 8, 8);
+						if (s < length[base + l] / 32) {
+							memcpy(&w2[l], p8 + 16, 8);
+							memcpy(&w3[l], p8 + 24, 8);
+						}
+						active[l] = ~uint64_t(0);
+					}
+				}
+
+				for (size_t l = 0; l < LANES; l++) {
+					uint64_t h0 = a[l], h1 = b[l], h2 = c[l] + w0[l], h3 = d[l] + w1[l];
+					ShortMix(h0, h1, h2, h3);
+					h0 += w2[l];
+					h1 += w3[l];
+					a[l] = (h0 & active[l]) | (a[l] & ~active[l]);
+					b[l] = (h1 & active[l]) | (b[l] & ~active[l]);
+					c[l] = (h2 & active[l]) | (c[l] & ~active[l]);
+					d[l] = (h3 & active[l]) | (d[l] & ~active[l]);
+				}
+			}
+
+			// Handle the last 0..15 bytes, and the length
+			for (size_t l = 0; l < lanes; l++) {
+				const size_t len = length[base + l];
+				if (len >= sc_bufSize) continue;
+				d[l] += ((uint64_t)len) << 56;
+				ShortTail((const uint8_t *)data[base + l] + len - len % 16, len % 16, c[l], d[l]);
+			}
+
+			for (size_t l = 0; l < LANES; l++) ShortEnd(a[l], b[l], c[l], d[l]);
+
+			for (size_t l = 0; l < lanes; l++) {
+				if (length[base + l] >= sc_bufSize) {
+					Hash128(data[base + l], length[base + l], &hash1[base + l], &hash2[base + l]);
+				} else {
+					hash1[base + l] = a[l];
+					hash2[base + l] = b[l];
+				}
+			}
+		}
+	}
+
 	/** Hashes long data to 64 bits.
 	 *
 	 * This version has a higher startup cost, and it is more efficient
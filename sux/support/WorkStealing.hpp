@@ -0,0 +1,114 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sux {
+
+using namespace std;
+
+/** Runs a set of tasks on a number of threads using work stealing.
+ *
+ * Tasks are identified by an integer in [0..`num_tasks`). Each thread
+ * starts with a contiguous range of tasks, which it consumes from the front;
+ * when its range is empty, it steals the upper half of the range of another
+ * thread. Tasks are thus executed roughly in increasing order by each thread,
+ * and a few expensive tasks do not leave the other threads idle.
+ *
+ * The function `f` is called as `f(task, thread)`, where `thread` is in
+ * [0..`num_threads`), so that it can use per-thread state without synchronization.
+ *
+ * @param num_tasks the number of tasks (less than 2<sup>32</sup>).
+ * @param num_threads the number of threads; if one, tasks are executed in order by the calling thread.
+ * @param f the function executing a task.
+ * @return the number of successful steals.
+ */
+
+template <typename F> size_t work_stealing(const size_t num_tasks, size_t num_threads, F &&f) {
+	assert(num_tasks < (UINT64_C(1) << 32));
+	if (num_threads > num_tasks) num_threads = num_tasks;
+	if (num_threads <= 1) {
+		for (size_t i = 0; i < num_tasks; i++) f(i, 0);
+		return 0;
+	}
+
+	// A range of tasks, packed as begin << 32 | end, on its own cache line
+	struct alignas(64) Range {
+		atomic<uint64_t> r;
+	};
+
+	vector<Range> range(num_threads);
+	for (size_t t = 0; t < num_threads; t++) range[t].r = (t * num_tasks / num_threads) << 32 | (t + 1) * num_tasks / num_threads;
+	atomic<size_t> steals(0);
+
+	auto worker = [&](const size_t t) {
+		for (;;) {
+			// Pop from the front of our own range
+			uint64_t r = range[t].r.load(memory_order_relaxed);
+			while (uint32_t(r >> 32) < uint32_t(r)) {
+				if (range[t].r.compare_exchange_weak(r, r + (UINT64_C(1) << 32), memory_order_relaxed)) {
+					f(r >> 32, t);
+					r = range[t].r.load(memory_order_relaxed);
+				}
+			}
+
+			// Steal the upper half of some other range
+			bool stolen = false;
+			for (size_t i = 1; i < num_threads && !stolen; i++) {
+				auto &victim = range[(t + i) % num_threads].r;
+				uint64_t v = victim.load(memory_order_relaxed);
+				for (;;) {
+					const uint32_t b = v >> 32, e = v;
+					if (b >= e) break;
+					const uint32_t m = b + (e - b) / 2;
+					if (victim.compare_exchange_weak(v, uint64_t(b) << 32 | m, memory_order_relaxed)) {
+						range[t].r.store(uint64_t(m) << 32 | e, memory_order_relaxed);
+						stolen = true;
+						break;
+					}
+				}
+			}
+			if (!stolen) return;
+			steals.fetch_add(1, memory_order_relaxed);
+		}
+	};
+
+	vector<thread> threads;
+	for (size_t t = 1; t < num_threads; t++) threads.emplace_back(worker, t);
+	worker(0);
+	for (auto &th : threads) th.join();
+	return steals;
+}
+
+} // namespace sux
@@ -34,12 +34,35 @@
 #include <cstring>
 #include <inttypes.h>
 #include <memory>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
 #include <x86intrin.h>
+#endif
 
 // Macro stringification
 #define __STRINGIFY(s) #s
 #define STRINGIFY(s) __STRINGIFY(s)
 
+// Function multiversioning: if the code is not compiled for a recent architecture
+// (i.e., without AVX2, as in a portable build without -march=native), hot kernels are
+// compiled also for POPCNT, x86-64-v3 (Haswell) and x86-64-v4 (AVX-512), and the best
+// version is chosen once at load time. Compilers that do not know the x86-64-vN levels
+// (GCC < 11, clang < 14) fall back to single-extension clones (AVX2 and POPCNT).
+// Define SUX_NO_MULTIVERSION to disable.
+#if defined(__x86_64__) && !defined(__AVX2__) && !defined(SUX_NO_MULTIVERSION) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#if (defined(__clang__) && __clang_major__ >= 14) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 11)
+#define SUX_MULTIVERSION __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "popcnt", "default")))
+#else
+#define SUX_MULTIVERSION __attribute__((target_clones("avx2", "popcnt", "default")))
+#endif
+#endif
+#endif
+#ifndef SUX_MULTIVERSION
+#define SUX_MULTIVERSION
+#endif
+
 // Explicit branch prediciton
 #define likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
@@ -352,7 +375,46 @@ inline uint64_t mround(uint64_t number, uint64_t multiple) { return ((number - 1
  */
 inline size_t updroot(size_t j, size_t n) { return n & (SIZE_MAX << lambda((j ^ n) | mask_rho(j))); }
 
-/** Returns the index of the k-th 1-bit in the 64-bit word x.
+#if defined(__x86_64__)
+
+/** Returns whether this CPU has a fast implementation of the PDEP instruction.
+ *
+ * PDEP is available on all CPUs supporting BMI2, but on AMD processors
+ * before Zen 3 (family 19h) it is microcoded and much slower than broadword code.
+ * The result is computed once using CPUID.
+ */
+inline bool has_fast_pdep() {
+	static const bool fast = [] {
+		unsigned int eax, ebx, ecx, edx;
+		if (__get_cpuid_max(0, nullptr) < 7) return false;
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		if ((ebx & bit_BMI) == 0 || (ebx & bit_BMI2) == 0) return false;
+
+		char vendor[13] = {0};
+		__cpuid(0, eax, ebx, ecx, edx);
+		memcpy(vendor, &ebx, 4);
+		memcpy(vendor + 4, &edx, 4);
+		memcpy(vendor + 8, &ecx, 4);
+		if (strcmp(vendor, "AuthenticAMD") != 0 && strcmp(vendor, "HygonGenuine") != 0) return true;
+
+		__cpuid(1, eax, ebx, ecx, edx);
+		const unsigned int family = ((eax >> 8) & 0xF) == 0xF ? 0xF + ((eax >> 20) & 0xFF) : (eax >> 8) & 0xF;
+		return family >= 0x19;
+	}();
+	return fast;
+}
+
+// Evaluated at startup, so that select64() tests a constant
+inline const bool fast_pdep = has_fast_pdep();
+
+#else
+
+// PDEP is available only on x86-64
+inline const bool fast_pdep = false;
+
+#endif
+
+/** Returns the index of the k-th 1-bit in the 64-bit word x using broadword code.
  * @param x 64-bit word.
  * @param k 0-based rank (`k = 0` returns the position of the first 1-bit).
  *
@@ -369,8 +431,7 @@ inline size_t updroot(size_t j, size_t n) { return n & (SIZE_MAX << lambda((j ^
  * [4] Facebook Folly library: https://github.com/facebook/folly
  *
  */
-inline uint64_t select64(uint64_t x, uint64_t k) {
-#ifndef __haswell__
+inline uint64_t select64_broadword(uint64_t x, uint64_t k) {
 	constexpr uint64_t kOnesStep4 = 0x1111111111111111ULL;
 	constexpr uint64_t kOnesStep8 = 0x0101010101010101ULL;
 	constexpr uint64_t kLAMBDAsStep8 = 0x80ULL * kOnesStep8;
@@ -386,7 +447,18 @@ inline uint64_t select64(uint64_t x, uint64_t k) {
 	uint64_t place = nu(geqKStep8) * 8;
 	uint64_t byteRank = k - (((byteSums << 8) >> place) & uint64_t(0xFF));
 	return place + kSelectInByte[((x >> place) & 0xFF) | (byteRank << 8)];
-#elif defined(__GNUC__) || defined(__clang__)
+}
+
+#if defined(__x86_64__)
+
+/** Returns the index of the k-th 1-bit in the 64-bit word x using PDEP and TZCNT.
+ * @param x 64-bit word.
+ * @param k 0-based rank (`k = 0` returns the position of the first 1-bit).
+ *
+ * This function must be called only on CPUs supporting BMI2 (see has_fast_pdep()).
+ * Since it uses inline assembly, it does not need BMI2 to be enabled at compile time.
+ */
+inline uint64_t select64_pdep(uint64_t x, uint64_t k) {
 	// GCC and Clang won't inline the intrinsics.
 	uint64_t result = uint64_t(1) << k;
 
@@ -396,8 +468,26 @@ inline uint64_t select64(uint64_t x, uint64_t k) {
 		: "r"(x));
 
 	return result;
+}
+
+#endif
+
+/** Returns the index of the k-th 1-bit in the 64-bit word x.
+ * @param x 64-bit word.
+ * @param k 0-based rank (`k = 0` returns the position of the first 1-bit).
+ *
+ * If the code is compiled for Haswell, this function uses select64_pdep(). Otherwise,
+ * it uses select64_pdep() if has_fast_pdep() returned true at startup, and
+ * select64_broadword() otherwise, so that the same binary is fast on all CPUs.
+ * Defining `SUX_NO_PDEP`, or compiling for a target other than x86-64, forces select64_broadword().
+ */
+inline uint64_t select64(uint64_t x, uint64_t k) {
+#if defined(SUX_NO_PDEP) || !defined(__x86_64__)
+	return select64_broadword(x, k);
+#elif defined(__haswell__)
+	return select64_pdep(x, k);
 #else
-	return _tzcnt_u64(_pdep_u64(1ULL << k, x));
+	return fast_pdep ? select64_pdep(x, k) : select64_broadword(x, k);
 #endif
 }
 
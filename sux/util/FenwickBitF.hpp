@@ -70,7 +70,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 			for (size_t idx = m; idx <= Size; idx += m) addToPartialFrequency(idx, getPartialFrequency(idx - m / 2));
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -81,7 +81,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			addToPartialFrequency(idx, inc);
 			idx += mask_rho(idx);
@@ -89,7 +89,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -107,7 +107,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 	}
 
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -125,7 +125,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 		return node;
 	}
 
-	virtual void push(uint64_t val) {
+	void push(uint64_t val) final {
 		Tree.resize((first_bit_after(++Size) + END_PADDING + 7) >> 3);
 		addToPartialFrequency(Size, val);
 
@@ -134,7 +134,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitF : public Search
 		}
 	}
 
-	virtual void pop() { Tree.resize((first_bit_after(--Size) + END_PADDING + 7) >> 3); }
+	void pop() final { Tree.resize((first_bit_after(--Size) + END_PADDING + 7) >> 3); }
 
 	virtual void grow(size_t space) { Tree.grow((first_bit_after(space) + END_PADDING + 7) >> 3); }
 
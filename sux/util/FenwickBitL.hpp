@@ -80,7 +80,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 		}
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -94,7 +94,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			const int height = rho(idx);
 			const size_t pos = (idx >> (1 + height)) * (BOUNDSIZE + height);
@@ -105,7 +105,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -128,7 +128,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 	}
 
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -150,7 +150,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 		return min(node, Size);
 	}
 
-	virtual void push(uint64_t val) {
+	void push(uint64_t val) final {
 		Levels = lambda(++Size) + 1;
 
 		int height = rho(Size);
@@ -170,7 +170,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickBitL : public Search
 		}
 	}
 
-	virtual void pop() {
+	void pop() final {
 		int height = rho(Size);
 		size_t pos = (BOUNDSIZE + height) * (Size >> (1 + height));
 		Tree[height].resize(pos / 8);
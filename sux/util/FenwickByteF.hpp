@@ -71,7 +71,10 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 		}
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final { return prefixKernel(idx); }
+
+  private:
+	SUX_MULTIVERSION uint64_t prefixKernel(size_t idx) {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -82,7 +85,8 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+  public:
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			bytewrite_inc(&Tree[pos(idx)], inc);
 			idx += mask_rho(idx);
@@ -90,7 +94,10 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final { return findKernel(val); }
+
+  private:
+	SUX_MULTIVERSION size_t findKernel(uint64_t *val) {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -107,8 +114,12 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 		return node;
 	}
 
+  public:
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final { return compFindKernel(val); }
+
+  private:
+	SUX_MULTIVERSION size_t compFindKernel(uint64_t *val) {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -125,7 +136,8 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 		return node;
 	}
 
-	virtual void push(uint64_t val) {
+  public:
+	void push(uint64_t val) final {
 		size_t p = pos(++Size);
 		Tree.resize(p + 8);
 		bytewrite(&Tree[p], bytesize(Size), val);
@@ -138,7 +150,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteF : public Searc
 		}
 	}
 
-	virtual void pop() { Size--; }
+	void pop() final { Size--; }
 
 	virtual void grow(size_t space) { Tree.grow(pos(space) + 8); }
 
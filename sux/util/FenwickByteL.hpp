@@ -80,7 +80,10 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 		}
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final { return prefixKernel(idx); }
+
+  private:
+	SUX_MULTIVERSION uint64_t prefixKernel(size_t idx) {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -95,7 +98,8 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+  public:
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			int height = rho(idx);
 			size_t isize = heightsize(height);
@@ -107,7 +111,10 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final { return findKernel(val); }
+
+  private:
+	SUX_MULTIVERSION size_t findKernel(uint64_t *val) {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -130,8 +137,12 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 		return min(node, Size);
 	}
 
+  public:
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final { return compFindKernel(val); }
+
+  private:
+	SUX_MULTIVERSION size_t compFindKernel(uint64_t *val) {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -154,7 +165,8 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 		return min(node, Size);
 	}
 
-	virtual void push(uint64_t val) {
+  public:
+	void push(uint64_t val) final {
 		Levels = lambda(++Size) + 1;
 
 		int height = rho(Size);
@@ -178,7 +190,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickByteL : public Searc
 		}
 	}
 
-	virtual void pop() {
+	void pop() final {
 		int height = rho(Size);
 		Tree[height].resize((Size >> (1 + height)) * heightsize(height) + 7);
 		Size--;
@@ -68,7 +68,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 		}
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -79,7 +79,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			Tree[pos(idx)] += inc;
 			idx += mask_rho(idx);
@@ -87,7 +87,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -105,7 +105,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 	}
 
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final {
 		size_t node = 0;
 
 		for (size_t m = mask_lambda(Size); m != 0; m >>= 1) {
@@ -122,7 +122,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 		return node;
 	}
 
-	virtual void push(uint64_t val) {
+	void push(uint64_t val) final {
 		size_t p = pos(++Size);
 		Tree.resize(p + 1);
 		Tree[p] = val;
@@ -132,7 +132,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedF : public Sear
 		}
 	}
 
-	virtual void pop() {
+	void pop() final {
 		Size--;
 		Tree.popBack();
 	}
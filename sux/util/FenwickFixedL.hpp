@@ -77,7 +77,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 		}
 	}
 
-	virtual uint64_t prefix(size_t idx) {
+	uint64_t prefix(size_t idx) final {
 		uint64_t sum = 0;
 
 		while (idx != 0) {
@@ -91,7 +91,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 		return sum;
 	}
 
-	virtual void add(size_t idx, int64_t inc) {
+	void add(size_t idx, int64_t inc) final {
 		while (idx <= Size) {
 			const int height = rho(idx);
 			size_t level_idx = idx >> (1 + height);
@@ -102,7 +102,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 	}
 
 	using SearchablePrefixSums::find;
-	virtual size_t find(uint64_t *val) {
+	size_t find(uint64_t *val) final {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -124,7 +124,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 	}
 
 	using SearchablePrefixSums::compFind;
-	virtual size_t compFind(uint64_t *val) {
+	size_t compFind(uint64_t *val) final {
 		size_t node = 0, idx = 0;
 
 		for (size_t height = Levels - 1; height != SIZE_MAX; height--) {
@@ -145,7 +145,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 		return min(node, Size);
 	}
 
-	virtual void push(uint64_t val) {
+	void push(uint64_t val) final {
 		Levels = lambda(++Size) + 1;
 
 		int height = rho(Size);
@@ -161,7 +161,7 @@ template <size_t BOUND, AllocType AT = MALLOC> class FenwickFixedL : public Sear
 		}
 	}
 
-	virtual void pop() {
+	void pop() final {
 		int height = rho(Size--);
 		Tree[height].popBack();
 	}
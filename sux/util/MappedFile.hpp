@@ -0,0 +1,102 @@
+/*
+ * Sux: Succinct data structures
+ *
+ * Copyright (C) 2019-2020 Sebastiano Vigna
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation; either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * Under Section 7 of GPL version 3, you are granted additional permissions
+ * described in the GCC Runtime Library Exception, version 3.1, as published by
+ * the Free Software Foundation.
+ *
+ * You should have received a copy of the GNU General Public License and a copy of
+ * the GCC Runtime Library Exception along with this program; see the files
+ * COPYING3 and COPYING.RUNTIME respectively.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace sux::util {
+
+/** A read-only memory mapping of a file.
+ *
+ * Structures serialized by their `<<` operator can be used in place, without
+ * copying, by passing a pointer into the mapping to their view constructors:
+ * the cost of loading them is then just the cost of the page faults.
+ *
+ *     util::MappedFile file("rank.idx");
+ *     const char *image = file.data();
+ *     auto bits = util::Vector<uint64_t>::view(image);
+ *     bits::Rank9Sel rs(&bits, image);
+ *
+ * The mapping must outlive the views created from it.
+ */
+class MappedFile {
+	void *addr = nullptr;
+	size_t length = 0;
+
+	// Closes a file descriptor and throws an exception for the current value of errno
+	[[noreturn]] static void fail(const int fd, const char *path) {
+		const int error = errno;
+		close(fd);
+		throw std::system_error(error, std::generic_category(), path);
+	}
+
+  public:
+	/** Maps a file in memory.
+	 *
+	 * @param path the path of the file.
+	 * @throws std::system_error if the file cannot be opened or mapped.
+	 */
+	explicit MappedFile(const char *path) {
+		const int fd = open(path, O_RDONLY);
+		if (fd == -1) throw std::system_error(errno, std::generic_category(), path);
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) fail(fd, path);
+		length = st.st_size;
+		if (length != 0) {
+			addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+			if (addr == MAP_FAILED) {
+				addr = nullptr;
+				fail(fd, path);
+			}
+		}
+		close(fd);
+	}
+
+	~MappedFile() {
+		if (addr) munmap(addr, length);
+	}
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/** Returns a pointer to the start of the mapping. */
+	const char *data() const { return static_cast<const char *>(addr); }
+
+	/** Returns the length in bytes of the mapping. */
+	size_t size() const { return length; }
+};
+
+} // namespace sux::util
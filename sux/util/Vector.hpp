@@ -34,6 +34,7 @@
 #include <iostream>
 #include <string>
 #include <sys/mman.h>
+#include <utility>
 
 namespace sux::util {
 
@@ -69,7 +70,9 @@ enum AllocType {
  * and the allocated space can be used directly, if necessary.
  *
  * This class implements the standard `<<` and `>>` operators for simple
- * serialization and deserialization.
+ * serialization and deserialization. A serialized vector can also be used in place,
+ * without copying, by means of view(), which makes it possible to access structures
+ * stored in a memory-mapped file (see MappedFile).
  *
  * @tparam T the data type of an element.
  * @tparam AT a type of memory allocation out of ::AllocType.
@@ -99,7 +102,8 @@ template <typename T, AllocType AT = MALLOC> class Vector : public Expandable {
 	explicit Vector<T, AT>(const T *data, size_t length) : Vector(length) { memcpy(this->data, data, length); }
 
 	~Vector<T, AT>() {
-		if (data) {
+		// Views have no capacity, and do not own their backing array
+		if (data && _capacity) {
 			if (AT == MALLOC) {
 				free(data);
 			} else {
@@ -228,7 +232,29 @@ template <typename T, AllocType AT = MALLOC> class Vector : public Expandable {
 	/** Returns the number of bits used by this vector.
 	 * @return the number of bits used by this vector.
 	 */
-	size_t bitCount() const { return sizeof(*this) * 8 + _capacity * sizeof(T) * 8; }
+	size_t bitCount() const { return sizeof(*this) * 8 + (_capacity == 0 ? _size : _capacity) * sizeof(T) * 8; }
+
+	/** Returns a read-only view of a vector serialized by the `<<` operator.
+	 *
+	 * The view does not own its backing array, which is the serialized data
+	 * itself, and it must be neither modified nor enlarged. The data must be aligned
+	 * on `alignof(T)`: this is always the case in a memory-mapped file containing
+	 * structures of this library serialized one after the other.
+	 *
+	 * @param image a pointer to a serialized vector; it is advanced past the vector.
+	 * @return a view of the serialized vector.
+	 */
+	static Vector<T, AT> view(const char *&image) {
+		uint64_t nsize;
+		memcpy(&nsize, image, sizeof(uint64_t));
+		image += sizeof(uint64_t);
+		assert(reinterpret_cast<uintptr_t>(image) % alignof(T) == 0 && "misaligned view");
+		Vector<T, AT> vector;
+		vector._size = nsize;
+		vector.data = nsize == 0 ? nullptr : reinterpret_cast<T *>(const_cast<char *>(image));
+		image += nsize * sizeof(T);
+		return vector;
+	}
 
   private:
 	static size_t page_aligned(size_t size) {
@@ -290,4 +316,36 @@ template <typename T, AllocType AT = MALLOC> class Vector : public Expandable {
 	}
 };
 
+/** Writes scalars as 64-bit words.
+ *
+ * Serialized structures write their scalar fields using this function, so that
+ * the vectors following them are aligned and can be used as views.
+ */
+template <typename... S> void write_words(std::ostream &os, const S &...s) {
+	static_assert(((sizeof(S) <= sizeof(uint64_t)) && ...), "scalars must fit a word");
+	(..., [&] {
+		const uint64_t word = s;
+		os.write((char *)&word, sizeof(uint64_t));
+	}());
+}
+
+/** Reads scalars written by write_words(). */
+template <typename... S> void read_words(std::istream &is, S &...s) {
+	(..., [&] {
+		uint64_t word;
+		is.read((char *)&word, sizeof(uint64_t));
+		s = word;
+	}());
+}
+
+/** Reads scalars written by write_words() from a memory image, advancing the image past them. */
+template <typename... S> void view_words(const char *&image, S &...s) {
+	(..., [&] {
+		uint64_t word;
+		memcpy(&word, image, sizeof(uint64_t));
+		image += sizeof(uint64_t);
+		s = word;
+	}());
+}
+
 } // namespace sux::util
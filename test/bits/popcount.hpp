@@ -0,0 +1,49 @@
+#pragma once
+
+#include <sux/support/Popcount.hpp>
+
+TEST(popcount_test, kernels) {
+	const size_t max_words = 1000;
+	uint64_t *const words = new uint64_t[max_words + 1];
+	uint64_t *const out = new uint64_t[max_words + 1];
+	uint64_t *const counts = new uint64_t[2 * (max_words / 8 + 2)];
+
+	for (size_t n = 0; n <= max_words; n += n < 40 ? 1 : 37) {
+		for (size_t i = 0; i < max_words + 1; i++) words[i] = n % 3 == 0 ? next() & next() : next();
+
+		// Odd offsets exercise unaligned vector loads
+		for (size_t offset = 0; offset < 2; offset++) {
+			const uint64_t *const w = words + offset;
+			uint64_t expected = 0;
+			for (size_t i = 0; i < n; i++) expected += __builtin_popcountll(w[i]);
+			ASSERT_EQ(expected, sux::popcount(w, n)) << n << " " << offset;
+
+			for (size_t block_words : {1, 3, 8, 16, 100}) {
+				ASSERT_EQ(expected, sux::popcount_blocks(w, n, block_words, out)) << n << " " << block_words;
+				for (size_t b = 0; b * block_words < n; b++) {
+					uint64_t c = 0;
+					for (size_t i = b * block_words; i < std::min((b + 1) * block_words, n); i++) c += __builtin_popcountll(w[i]);
+					ASSERT_EQ(c, out[b]) << n << " " << block_words << " " << b;
+				}
+			}
+
+			ASSERT_EQ(expected, sux::rank9_counts(w, n, counts)) << n;
+			uint64_t ones = 0;
+			for (size_t i = 0; i < n; i += 8) {
+				ASSERT_EQ(ones, counts[i / 4]) << n << " " << i;
+				uint64_t block = 0;
+				for (int j = 0; j < 8; j++) {
+					if (j > 0) {
+						ASSERT_EQ(block, counts[i / 4 + 1] >> 9 * (j - 1) & 0x1FF) << n << " " << i << " " << j;
+					}
+					if (i + j < n) block += __builtin_popcountll(w[i + j]);
+				}
+				ones += block;
+			}
+		}
+	}
+
+	delete[] words;
+	delete[] out;
+	delete[] counts;
+}
@@ -1,11 +1,21 @@
 #pragma once
 
+#include <sux/bits/AppendRank9Sel.hpp>
 #include <sux/bits/EliasFano.hpp>
+#include <sux/bits/InterleavedRank.hpp>
 #include <sux/bits/Rank9Sel.hpp>
+#include <sux/bits/Rank9SelZero.hpp>
+#include <sux/bits/RunLengthRankSel.hpp>
 #include <sux/bits/SimpleSelect.hpp>
+#include <sux/bits/SimpleSelectBoth.hpp>
 #include <sux/bits/SimpleSelectHalf.hpp>
+#include <sux/bits/SimpleSelectTuner.hpp>
 #include <sux/bits/SimpleSelectZero.hpp>
 #include <sux/bits/SimpleSelectZeroHalf.hpp>
+#include <sux/util/MappedFile.hpp>
+
+#include <fstream>
+#include <sstream>
 
 TEST(rankselect, all_ones) {
 	using namespace sux::bits;
@@ -157,3 +167,448 @@ TEST(rankselect, small_large) {
 	run_rankselect(1024);
 	run_rankselect(512 * 1024);
 }
+
+TEST(rankselect, parallel) {
+	using namespace sux::bits;
+	const size_t size = 1 << 24, words = size / 64 + 1;
+	uint64_t *bitvect = new uint64_t[words]();
+
+	// Alternate dense and very sparse regions, so that all kinds of subinventories are used
+	for (size_t i = 0; i < size / 64; i++) bitvect[i] = (i / 4096) % 2 ? next() : (next() % 1000 == 0 ? UINT64_C(1) << next() % 64 : 0);
+
+	Rank9Sel<> serial(bitvect, size);
+	Rank9Sel<> parallel(bitvect, size, 4);
+
+	EXPECT_EQ(serial.rank(size), parallel.rank(size));
+	for (size_t pos = 0; pos < size; pos += 997) EXPECT_EQ(serial.rank(pos), parallel.rank(pos));
+	const size_t ones = serial.rank(size);
+	for (size_t i = 0; i < ones; i += 101) EXPECT_EQ(serial.select(i), parallel.select(i));
+	EXPECT_EQ(serial.select(ones - 1), parallel.select(ones - 1));
+
+	// The structures of the Simple family do not depend on the number of threads
+	const auto serialize = [](const auto &s) {
+		std::stringstream ss;
+		ss << s;
+		return ss.str();
+	};
+	EXPECT_EQ(serialize(SimpleSelect<>(bitvect, size, 3)), serialize(SimpleSelect<>(bitvect, size, 3, 4)));
+	EXPECT_EQ(serialize(SimpleSelectZero<>(bitvect, size, 3)), serialize(SimpleSelectZero<>(bitvect, size, 3, 4)));
+	EXPECT_EQ(serialize(SimpleSelectHalf<>(bitvect, size)), serialize(SimpleSelectHalf<>(bitvect, size, 4)));
+	EXPECT_EQ(serialize(SimpleSelectZeroHalf<>(bitvect, size)), serialize(SimpleSelectZeroHalf<>(bitvect, size, 4)));
+	SimpleSelect<> simple(bitvect, size, 3, 4);
+	for (size_t i = 0; i < ones; i += 101) EXPECT_EQ(serial.select(i), simple.select(i));
+
+	delete[] bitvect;
+}
+
+// Generic code using the static interfaces
+template <typename R, typename S> static void check_static(sux::StaticRank<R> &r, sux::StaticSelect<S> &s, sux::Rank &vr, sux::Select &vs, const size_t size) {
+	for (size_t pos = 0; pos < size; pos += 7) {
+		EXPECT_EQ(vr.rank(pos), r.rank(pos));
+		EXPECT_EQ(vr.rankZero(pos), r.rankZero(pos));
+		EXPECT_EQ(vr.rank(pos / 2, pos), r.rank(pos / 2, pos));
+		EXPECT_EQ(pos - r.rank(pos), r.rankZero(0, pos));
+	}
+	const size_t ones = r.rank(size);
+	for (size_t i = 0; i < ones; i += 3) EXPECT_EQ(vs.select(i), s.select(i));
+}
+
+TEST(rankselect, static_interface) {
+	using namespace sux::bits;
+	const size_t size = 100000, words = size / 64 + 1;
+	uint64_t *bitvect = new uint64_t[words]();
+	for (size_t i = 0; i < size / 64; i++) bitvect[i] = next() & next();
+
+	Rank9Sel<> rank9sel(bitvect, size);
+	check_static(rank9sel, rank9sel, rank9sel, rank9sel, size);
+	EliasFano<> eliasfano(bitvect, size);
+	check_static(eliasfano, eliasfano, eliasfano, eliasfano, size);
+
+	delete[] bitvect;
+}
+
+TEST(rankselect, batch) {
+	using namespace sux::bits;
+	for (size_t size : {0, 1, 64, 1000, 100000, 1000000}) {
+		const size_t words = size / 64 + 1;
+		uint64_t *bitvect = new uint64_t[words]();
+		for (size_t i = 0; i < size / 64; i++) bitvect[i] = size > 1000 ? next() & next() & next() : next();
+		if (size == 100000) bitvect[500] = bitvect[501] = 0, bitvect[700] = ~0ULL;
+
+		Rank9Sel<> rank9sel(bitvect, size);
+		SimpleSelect<> simple(bitvect, size, 3);
+		SimpleSelectHalf<> simplehalf(bitvect, size);
+		EliasFano<> eliasfano(bitvect, size);
+
+		const size_t num_ones = rank9sel.rank(size);
+		std::vector<size_t> pos(1000);
+		for (auto &p : pos) p = next() % (size + 1);
+		std::vector<uint64_t> out(pos.size());
+		rank9sel.rank(pos.data(), out.data(), pos.size());
+		for (size_t i = 0; i < pos.size(); i++) ASSERT_EQ(rank9sel.rank(pos[i]), out[i]) << pos[i];
+
+		if (num_ones == 0) {
+			delete[] bitvect;
+			continue;
+		}
+
+		std::vector<uint64_t> rank(1000);
+		for (auto &r : rank) r = next() % num_ones;
+		rank9sel.select(rank.data(), out.data(), rank.size());
+		for (size_t i = 0; i < rank.size(); i++) ASSERT_EQ(rank9sel.select(rank[i]), out[i]) << rank[i];
+		simple.select(rank.data(), out.data(), rank.size());
+		for (size_t i = 0; i < rank.size(); i++) ASSERT_EQ(simple.select(rank[i]), out[i]) << rank[i];
+		simplehalf.select(rank.data(), out.data(), rank.size());
+		for (size_t i = 0; i < rank.size(); i++) ASSERT_EQ(simplehalf.select(rank[i]), out[i]) << rank[i];
+		eliasfano.select(rank.data(), out.data(), rank.size());
+		for (size_t i = 0; i < rank.size(); i++) ASSERT_EQ(eliasfano.select(rank[i]), out[i]) << rank[i];
+
+		delete[] bitvect;
+	}
+}
+
+template <typename T, typename U> void check_same(T &a, U &b, const size_t size) {
+	const size_t num_ones = a.rank(size);
+	ASSERT_EQ(num_ones, b.rank(size));
+	for (int i = 0; i < 1000; i++) {
+		const size_t pos = next() % (size + 1);
+		ASSERT_EQ(a.rank(pos), b.rank(pos)) << pos;
+		if (num_ones == 0) continue;
+		const uint64_t rank = next() % num_ones;
+		ASSERT_EQ(a.select(rank), b.select(rank)) << rank;
+	}
+}
+
+TEST(rankselect, dump_and_load) {
+	using namespace sux::bits;
+	const char *filename = "test/test_dump";
+	for (size_t size : {0, 1000, 100000}) {
+		sux::util::Vector<uint64_t> bits(size / 64 + 1);
+		for (size_t i = 0; i < size / 64; i++) bits[i] = next() & next();
+		if (size > 1000) bits[100] = bits[101] = 0, bits[200] = ~0ULL;
+
+		Rank9Sel<> rank9sel(&bits, size);
+		SimpleSelect<> simple(&bits, size, 3);
+		SimpleSelectHalf<> simplehalf(&bits, size);
+		SimpleSelectZero<> simplezero(&bits, size, 3);
+		SimpleSelectZeroHalf<> simplezerohalf(&bits, size);
+		EliasFano<> eliasfano(&bits, size);
+
+		fstream fs;
+		fs.exceptions(fstream::failbit | fstream::badbit);
+		fs.open(filename, fstream::out | fstream::binary | fstream::trunc);
+		fs << bits << rank9sel << simple << simplehalf << simplezero << simplezerohalf << eliasfano;
+		fs.close();
+
+		// Stream deserialization
+		fs.open(filename, fstream::in | fstream::binary);
+		sux::util::Vector<uint64_t> loaded_bits;
+		fs >> loaded_bits;
+		Rank9Sel<> loaded_rank9sel(&loaded_bits, fs);
+		SimpleSelect<> loaded_simple(&loaded_bits, fs);
+		SimpleSelectHalf<> loaded_simplehalf(&loaded_bits, fs);
+		SimpleSelectZero<> loaded_simplezero(&loaded_bits, fs);
+		SimpleSelectZeroHalf<> loaded_simplezerohalf(&loaded_bits, fs);
+		EliasFano<> loaded_eliasfano;
+		fs >> loaded_eliasfano;
+		fs.close();
+
+		check_same(rank9sel, loaded_rank9sel, size);
+		check_same(eliasfano, loaded_eliasfano, size);
+		for (int i = 0; i < 1000 && size > 0; i++) {
+			const uint64_t ones = rank9sel.rank(size), zeros = size - ones;
+			if (ones) {
+				const uint64_t rank = next() % ones;
+				ASSERT_EQ(simple.select(rank), loaded_simple.select(rank));
+				ASSERT_EQ(simplehalf.select(rank), loaded_simplehalf.select(rank));
+			}
+			if (zeros) {
+				const uint64_t rank = next() % zeros;
+				ASSERT_EQ(simplezero.selectZero(rank), loaded_simplezero.selectZero(rank));
+				ASSERT_EQ(simplezerohalf.selectZero(rank), loaded_simplezerohalf.selectZero(rank));
+			}
+		}
+
+		// Memory-mapped views
+		{
+			sux::util::MappedFile file(filename);
+			const char *image = file.data();
+			auto view_bits = sux::util::Vector<uint64_t>::view(image);
+			Rank9Sel<> view_rank9sel(&view_bits, image);
+			SimpleSelect<> view_simple(&view_bits, image);
+			SimpleSelectHalf<> view_simplehalf(&view_bits, image);
+			SimpleSelectZero<> view_simplezero(&view_bits, image);
+			SimpleSelectZeroHalf<> view_simplezerohalf(&view_bits, image);
+			EliasFano<> view_eliasfano(image);
+			ASSERT_EQ(file.data() + file.size(), image);
+			ASSERT_EQ(rank9sel.bitCount(), view_rank9sel.bitCount());
+
+			check_same(rank9sel, view_rank9sel, size);
+			check_same(eliasfano, view_eliasfano, size);
+			for (int i = 0; i < 1000 && size > 0; i++) {
+				const uint64_t ones = rank9sel.rank(size), zeros = size - ones;
+				if (ones) {
+					const uint64_t rank = next() % ones;
+					ASSERT_EQ(simple.select(rank), view_simple.select(rank));
+					ASSERT_EQ(simplehalf.select(rank), view_simplehalf.select(rank));
+				}
+				if (zeros) {
+					const uint64_t rank = next() % zeros;
+					ASSERT_EQ(simplezero.selectZero(rank), view_simplezero.selectZero(rank));
+					ASSERT_EQ(simplezerohalf.selectZero(rank), view_simplezerohalf.selectZero(rank));
+				}
+			}
+		}
+
+		remove(filename);
+	}
+
+	EXPECT_THROW(sux::util::MappedFile("/nonexistent/rank.idx"), std::system_error);
+}
+
+TEST(rankselect, interleaved) {
+	using namespace sux::bits;
+	for (size_t size : {0, 1, 63, 64, 447, 448, 449, 896, 1000, 100000}) {
+		sux::util::Vector<uint64_t> bits(size / 64 + 1);
+		for (size_t i = 0; i < size / 64; i++) bits[i] = next() & next();
+		if (size % 64) bits[size / 64] = next() & ((UINT64_C(1) << size % 64) - 1);
+
+		Rank9<> rank9(&bits, size);
+		InterleavedRank<> copy(&bits, size);
+		sux::util::Vector<uint64_t> moved(size / 64 + 1);
+		for (size_t i = 0; i < size / 64 + 1; i++) moved[i] = bits[i];
+		InterleavedRank<> in_place(std::move(moved), size);
+
+		ASSERT_EQ(size, copy.size());
+		for (size_t pos = 0; pos <= size; pos++) {
+			ASSERT_EQ(rank9.rank(pos), copy.rank(pos)) << pos;
+			ASSERT_EQ(rank9.rank(pos), in_place.rank(pos)) << pos;
+			if (pos < size) {
+				ASSERT_EQ(bits[pos / 64] >> pos % 64 & 1, copy[pos]) << pos;
+				ASSERT_EQ(bits[pos / 64] >> pos % 64 & 1, in_place[pos]) << pos;
+			}
+		}
+
+		std::vector<size_t> pos(100);
+		for (auto &p : pos) p = next() % (size + 1);
+		std::vector<uint64_t> out(pos.size());
+		copy.rank(pos.data(), out.data(), pos.size());
+		for (size_t i = 0; i < pos.size(); i++) ASSERT_EQ(rank9.rank(pos[i]), out[i]) << pos[i];
+	}
+}
+
+TEST(rankselect, run_length) {
+	using namespace sux::bits;
+	for (size_t size : {0, 1, 2, 63, 64, 65, 1000, 100000}) {
+		// Mean run lengths from very short (worst case) to long (clustered)
+		for (uint64_t mean : {1, 3, 100}) {
+			for (bool first : {false, true}) {
+				uint64_t *bitvect = new uint64_t[size / 64 + 1]();
+				bool one = first;
+				for (size_t i = 0; i < size; i++) {
+					if (next() % mean == 0) one = !one;
+					if (one) bitvect[i / 64] |= UINT64_C(1) << i % 64;
+				}
+
+				Rank9Sel<> rank9sel(bitvect, size);
+				RunLengthRankSel<> runs(bitvect, size);
+				SimpleSelectZero<> selectzero(bitvect, size, 3);
+				ASSERT_EQ(size, runs.size());
+
+				for (size_t pos = 0; pos <= size; pos++) ASSERT_EQ(rank9sel.rank(pos), runs.rank(pos)) << pos;
+				const uint64_t num_ones = rank9sel.rank(size);
+				for (uint64_t rank = 0; rank < num_ones; rank++) ASSERT_EQ(rank9sel.select(rank), runs.select(rank)) << rank;
+				for (uint64_t rank = 0; rank < size - num_ones; rank++) ASSERT_EQ(selectzero.selectZero(rank), runs.selectZero(rank)) << rank;
+
+				delete[] bitvect;
+			}
+		}
+	}
+}
+
+TEST(rankselect, select_zero) {
+	using namespace sux::bits;
+	for (size_t size : {0, 1, 63, 64, 65, 1000, 100000, 1 << 22}) {
+		// Densities of ones from very sparse to very dense, so that both inventories meet all span cases
+		for (uint64_t density : {1, 50, 500, 950, 999}) {
+			uint64_t *bitvect = new uint64_t[size / 64 + 1]();
+			for (size_t i = 0; i < size; i++)
+				if (next() % 1000 < density) bitvect[i / 64] |= UINT64_C(1) << i % 64;
+
+			Rank9Sel<> rank9sel(bitvect, size);
+			Rank9SelZero<> rank9selzero(bitvect, size);
+			Rank9SelZero<> parallel(bitvect, size, 4);
+			SimpleSelectZero<> selectzero(bitvect, size, 3);
+
+			const uint64_t num_ones = rank9sel.rank(size);
+			for (size_t pos = 0; pos <= size; pos += 1 + size / 10000) ASSERT_EQ(rank9sel.rank(pos), rank9selzero.rank(pos)) << pos;
+			for (uint64_t rank = 0; rank < num_ones; rank++) ASSERT_EQ(rank9sel.select(rank), rank9selzero.select(rank)) << rank;
+			for (uint64_t rank = 0; rank < size - num_ones; rank++) {
+				const uint64_t pos = selectzero.selectZero(rank);
+				ASSERT_EQ(pos, rank9selzero.selectZero(rank)) << rank;
+				ASSERT_EQ(pos, parallel.selectZero(rank)) << rank;
+			}
+
+			std::stringstream ss;
+			ss << rank9selzero;
+			Rank9SelZero<> loaded(bitvect, ss);
+			for (uint64_t rank = 0; rank < size - num_ones; rank += 1 + size / 10000) ASSERT_EQ(rank9selzero.selectZero(rank), loaded.selectZero(rank)) << rank;
+
+			delete[] bitvect;
+		}
+	}
+}
+
+TEST(rankselect, append) {
+	using namespace sux::bits;
+	// Densities of ones from very sparse to very dense, so that subinventories of all kinds are built
+	for (uint64_t density : {1, 50, 500, 999}) {
+		const size_t size = 1 << 20;
+		AppendRank9Sel<> append;
+		uint64_t *bitvect = new uint64_t[size / 64 + 2]();
+		size_t checkpoint = 0;
+
+		while (append.size() < size) {
+			// Appends of random width, including zero and full words
+			const int width = min(uint64_t(size - append.size()), next() % 66 % 65);
+			uint64_t value = 0;
+			for (int i = 0; i < width; i++)
+				if (next() % 1000 < density) value |= UINT64_C(1) << i;
+			for (int i = 0; i < width; i++)
+				if (value >> i & 1) bitvect[(append.size() + i) / 64] |= UINT64_C(1) << (append.size() + i) % 64;
+			append.append(value | (width < 64 ? -1ULL << width : 0), width);
+
+			if (append.size() >= checkpoint) {
+				const size_t n = append.size();
+				checkpoint = checkpoint * 3 / 2 + 100;
+				Rank9Sel<> rank9sel(bitvect, n);
+				const uint64_t num_ones = rank9sel.rank(n);
+				for (size_t pos = 0; pos <= n; pos += 1 + n / 5000) ASSERT_EQ(rank9sel.rank(pos), append.rank(pos)) << pos;
+				ASSERT_EQ(num_ones, append.rank(n));
+				for (uint64_t rank = 0; rank < num_ones; rank++) ASSERT_EQ(rank9sel.select(rank), append.select(rank)) << rank;
+			}
+		}
+
+		for (size_t pos = 0; pos < size; pos += 1 + size / 5000) ASSERT_EQ(bitvect[pos / 64] >> pos % 64 & 1, append[pos]) << pos;
+		delete[] bitvect;
+	}
+}
+
+TEST(rankselect, select_both) {
+	using namespace sux::bits;
+	for (size_t size : {0, 1, 63, 64, 65, 1000, 100000, 1 << 22}) {
+		// Densities of ones from very sparse to very dense, so that the two inventories have very different sizes
+		for (uint64_t density : {1, 50, 500, 950, 999}) {
+			uint64_t *bitvect = new uint64_t[size / 64 + 1]();
+			for (size_t i = 0; i < size; i++)
+				if (next() % 1000 < density) bitvect[i / 64] |= UINT64_C(1) << i % 64;
+
+			SimpleSelectHalf<> select(bitvect, size);
+			SimpleSelectZeroHalf<> selectzero(bitvect, size);
+			SimpleSelectBoth<> both(bitvect, size), parallel(bitvect, size, 4);
+
+			uint64_t num_ones = 0;
+			for (size_t i = 0; i < size; i++) num_ones += bitvect[i / 64] >> i % 64 & 1;
+			for (uint64_t rank = 0; rank < num_ones; rank++) ASSERT_EQ(select.select(rank), both.select(rank)) << rank;
+			for (uint64_t rank = 0; rank < size - num_ones; rank++) ASSERT_EQ(selectzero.selectZero(rank), both.selectZero(rank)) << rank;
+
+			std::stringstream ss, ps;
+			ss << both;
+			ps << parallel;
+			ASSERT_EQ(ss.str(), ps.str());
+			SimpleSelectBoth<> loaded(bitvect, ss);
+			for (uint64_t rank = 0; rank < num_ones; rank += 1 + size / 10000) ASSERT_EQ(both.select(rank), loaded.select(rank)) << rank;
+			for (uint64_t rank = 0; rank < size - num_ones; rank += 1 + size / 10000) ASSERT_EQ(both.selectZero(rank), loaded.selectZero(rank)) << rank;
+
+			delete[] bitvect;
+		}
+	}
+}
+
+TEST(rankselect, iterator) {
+	using namespace sux::bits;
+	for (size_t size : {1, 64, 1000, 100000, 1000000}) {
+		// Densities of ones from very sparse to very dense, so that scans cross many empty or full words
+		for (uint64_t density : {1, 50, 500, 999}) {
+			uint64_t *bitvect = new uint64_t[size / 64 + 1]();
+			for (size_t i = 0; i < size; i++)
+				if (next() % 1000 < density) bitvect[i / 64] |= UINT64_C(1) << i % 64;
+
+			Rank9Sel<> rank9sel(bitvect, size);
+			SimpleSelect<> simple(bitvect, size, 3);
+			EliasFano<> eliasfano(bitvect, size);
+
+			const uint64_t num_ones = rank9sel.rank(size);
+			if (num_ones == 0) {
+				delete[] bitvect;
+				continue;
+			}
+
+			for (int t = 0; t < 10; t++) {
+				const uint64_t from = next() % num_ones, to = from + next() % (num_ones - from + 1);
+				std::vector<uint64_t> out(to - from);
+
+				rank9sel.selectRange(from, to, out.data());
+				for (uint64_t r = from; r < to; r++) ASSERT_EQ(rank9sel.select(r), out[r - from]) << r;
+				simple.selectRange(from, to, out.data());
+				for (uint64_t r = from; r < to; r++) ASSERT_EQ(rank9sel.select(r), out[r - from]) << r;
+				eliasfano.selectRange(from, to, out.data());
+				for (uint64_t r = from; r < to; r++) ASSERT_EQ(rank9sel.select(r), out[r - from]) << r;
+
+				auto it = simple.iterator(from);
+				auto ef = eliasfano.iterator(from);
+				for (uint64_t r = from; r < to; r++) {
+					const uint64_t pos = rank9sel.select(r);
+					ASSERT_EQ(pos, it.next()) << r;
+					ASSERT_EQ(pos, ef.next()) << r;
+				}
+			}
+
+			delete[] bitvect;
+		}
+	}
+}
+
+TEST(rankselect, simple_select_tuner) {
+	using namespace sux::bits;
+	const size_t size = 1 << 21;
+	// Uniform, sparse, long runs, and sparse followed by dense (so that some entries are spilled)
+	for (int kind = 0; kind < 4; kind++) {
+		uint64_t *bitvect = new uint64_t[size / 64 + 1]();
+		bool one = false;
+		for (size_t i = 0; i < size; i++) {
+			if (kind == 0)
+				one = next() & 1;
+			else if (kind == 1)
+				one = next() % 100 == 0;
+			else if (kind == 2) {
+				if (next() % (one ? 1000 : 10000) == 0) one = !one;
+			} else
+				one = i < size / 2 ? next() % 1000 == 0 : next() & 1;
+			if (one) bitvect[i / 64] |= UINT64_C(1) << i % 64;
+		}
+
+		SimpleSelectTuner tuner(bitvect, size);
+		const auto &estimates = tuner.estimates();
+		ASSERT_EQ(SimpleSelectTuner<>::MAX_CANDIDATE + 1, (int)estimates.size());
+		for (const auto &e : estimates) {
+			// The space is exact
+			SimpleSelect simple(bitvect, size, e.max_log2_longwords_per_subinventory);
+			EXPECT_NEAR(simple.bitCount() - sizeof(simple) * 8, e.space * size, 1) << kind << " " << e;
+			EXPECT_GE(e.lines, 1) << kind << " " << e;
+		}
+		for (int c = 1; c <= SimpleSelectTuner<>::MAX_CANDIDATE; c++) EXPECT_LE(estimates[c].lines, estimates[c - 1].lines) << kind;
+
+		EXPECT_EQ(0, tuner.forSpace(0).max_log2_longwords_per_subinventory);
+		EXPECT_EQ(estimates.back().lines, tuner.forSpace(1).lines);
+		EXPECT_EQ(0, tuner.forLatency(100).max_log2_longwords_per_subinventory);
+
+		tuner.benchmark(1000);
+		for (const auto &e : tuner.estimates()) EXPECT_GT(e.ns, 0) << kind << " " << e;
+		const auto choice = tuner.forSpace(estimates[1].space);
+		EXPECT_LE(choice.space, estimates[1].space);
+		EXPECT_EQ(choice.ns, min(estimates[0].ns, estimates[1].ns));
+
+		delete[] bitvect;
+	}
+}
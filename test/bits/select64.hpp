@@ -0,0 +1,25 @@
+#pragma once
+
+#include <sux/support/common.hpp>
+
+TEST(select64_test, variants) {
+	for (int i = 0; i < 100000; i++) {
+		uint64_t x = next();
+		if (i % 3 == 0) x &= next();
+		if (x == 0) continue;
+		const uint64_t k = next() % sux::nu(x);
+
+		// Clear the k lowest ones
+		uint64_t y = x;
+		for (uint64_t r = 0; r < k; r++) y &= y - 1;
+		const uint64_t expected = __builtin_ctzll(y);
+
+		ASSERT_EQ(expected, sux::select64_broadword(x, k)) << x << " " << k;
+		ASSERT_EQ(expected, sux::select64(x, k)) << x << " " << k;
+#if defined(__x86_64__)
+		if (__builtin_cpu_supports("bmi2")) {
+			ASSERT_EQ(expected, sux::select64_pdep(x, k)) << x << " " << k;
+		}
+#endif
+	}
+}
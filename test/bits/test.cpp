@@ -2,7 +2,9 @@
 
 #include "../xoroshiro128pp.hpp"
 #include "dynranksel.hpp"
+#include "popcount.hpp"
 #include "rankselect.hpp"
+#include "select64.hpp"
 #include <sux/util/FenwickBitF.hpp>
 #include <sux/util/FenwickBitL.hpp>
 #include <sux/util/FenwickByteF.hpp>
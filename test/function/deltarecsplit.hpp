@@ -0,0 +1,110 @@
+#pragma once
+
+#include <sux/function/DeltaRecSplit.hpp>
+#include <vector>
+
+using namespace std;
+using namespace sux::function;
+
+template <class RS> static void deltarecsplit_check(RS &rs, const vector<hash128_t> &keys, const size_t max_value) {
+	vector<uint8_t> seen(max_value);
+	for (const auto &k : keys) {
+		ASSERT_TRUE(rs.contains(k));
+		const size_t v = rs(k);
+		ASSERT_LT(v, max_value);
+		ASSERT_EQ(0, seen[v]) << "value " << v << " assigned twice";
+		seen[v] = 1;
+	}
+}
+
+TEST(deltarecsplit_test, add_remove_merge) {
+	const size_t n = 100000;
+	vector<hash128_t> keys;
+	for (size_t i = 0; i < n; ++i) keys.push_back(hash128_t(next(), next()));
+
+	ASSERT_EQ(0, DeltaRecSplit<LEAF>().size());
+
+	DeltaRecSplit<LEAF> rs(keys, BUCKET_SIZE_TEST, 16);
+	ASSERT_EQ(n, rs.size());
+	deltarecsplit_check(rs, keys, n);
+
+	// Remove 1000 keys, add 1500 new ones: freed values are reused first
+	vector<hash128_t> current(keys.begin() + 1000, keys.end());
+	vector<size_t> freed;
+	for (size_t i = 0; i < 1000; i++) {
+		freed.push_back(rs(keys[i]));
+		rs.remove(keys[i]);
+		ASSERT_FALSE(rs.contains(keys[i]));
+	}
+	for (size_t i = 0; i < 1500; i++) {
+		hash128_t k(next(), next());
+		const size_t v = rs.add(k);
+		if (i < 1000) {
+			ASSERT_EQ(freed[999 - i], v);
+		}
+		ASSERT_EQ(v, rs(k));
+		current.push_back(k);
+	}
+
+	// A deleted key can come back
+	rs.remove(current[0]);
+	rs.add(current[0]);
+
+	ASSERT_EQ(n + 500, rs.size());
+	deltarecsplit_check(rs, current, n + 500);
+
+	auto merged = rs.merge();
+	ASSERT_EQ(0, merged.deltaSize());
+	ASSERT_EQ(n + 500, merged.size());
+	deltarecsplit_check(merged, current, n + 500);
+	for (size_t i = 0; i < 1000; i++) ASSERT_FALSE(merged.contains(keys[i]));
+
+	// The original instance is unaffected by the merge
+	deltarecsplit_check(rs, current, n + 500);
+}
+
+TEST(deltarecsplit_test, strings) {
+	vector<string> keys;
+	for (size_t i = 0; i < 10000; ++i) keys.push_back("key" + to_string(i));
+
+	DeltaRecSplit<LEAF> rs(keys, BUCKET_SIZE_TEST, 4);
+	const size_t v0 = rs(keys[0]);
+	rs.remove(keys[0]);
+	rs.add("new");
+	ASSERT_TRUE(rs.contains("new"));
+	ASSERT_FALSE(rs.contains(keys[0]));
+	ASSERT_EQ(v0, rs("new"));
+
+	keys[0] = "new";
+	auto merged = rs.merge();
+	vector<uint8_t> seen(keys.size());
+	for (const auto &k : keys) {
+		const size_t v = merged(k);
+		ASSERT_LT(v, keys.size());
+		ASSERT_EQ(0, seen[v]);
+		seen[v] = 1;
+	}
+}
+
+TEST(deltarecsplit_test, empty_shards) {
+	// Many more shards than keys, so that most shards are empty
+	vector<hash128_t> keys;
+	for (size_t i = 0; i < 3; ++i) keys.push_back(hash128_t(next(), next()));
+
+	DeltaRecSplit<LEAF> rs(keys, BUCKET_SIZE_TEST, 64);
+	deltarecsplit_check(rs, keys, 3);
+	for (size_t i = 0; i < 1000; i++) {
+		const hash128_t h(next(), next());
+		ASSERT_FALSE(rs.contains(h));
+		rs(h); // Arbitrary value, but no access to an empty shard
+	}
+
+	// Shards emptied by deletions
+	for (const auto &k : keys) rs.remove(k);
+	auto merged = rs.merge();
+	ASSERT_EQ(0, merged.size());
+	for (const auto &k : keys) {
+		ASSERT_FALSE(merged.contains(k));
+		merged(k);
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <sstream>
+#include <sux/function/DoubleEF.hpp>
+#include <vector>
+
+using namespace std;
+using namespace sux::function;
+
+TEST(doubleef_test, batch) {
+	const size_t n = 100000;
+	vector<uint64_t> cum_keys(n + 1), position(n + 1);
+	for (size_t i = 1; i <= n; i++) {
+		const uint64_t keys = next() % 200;
+		cum_keys[i] = cum_keys[i - 1] + keys;
+		position[i] = position[i - 1] + keys * 2 + next() % 64;
+	}
+
+	DoubleEF<> ef(cum_keys, position);
+
+	vector<uint64_t> index(10000);
+	for (auto &i : index) i = next() % n;
+	vector<uint64_t> ck(index.size()), ckn(index.size()), pos(index.size());
+
+	ef.get(index.data(), index.size(), ck.data(), ckn.data(), pos.data());
+	for (size_t j = 0; j < index.size(); j++) {
+		ASSERT_EQ(cum_keys[index[j]], ck[j]) << j;
+		ASSERT_EQ(cum_keys[index[j] + 1], ckn[j]) << j;
+		ASSERT_EQ(position[index[j]], pos[j]) << j;
+	}
+
+	fill(ck.begin(), ck.end(), 0);
+	fill(pos.begin(), pos.end(), 0);
+	ef.get(index.data(), index.size(), ck.data(), pos.data());
+	for (size_t j = 0; j < index.size(); j++) {
+		ASSERT_EQ(cum_keys[index[j]], ck[j]) << j;
+		ASSERT_EQ(position[index[j]], pos[j]) << j;
+	}
+}
+
+TEST(doubleef_test, wide_jumps) {
+	// A single huge gap makes the upper bits of the first superblock longer than 2^16 bits
+	const size_t n = 40000;
+	vector<uint64_t> cum_keys(n + 1), position(n + 1);
+	for (size_t i = 1; i <= n; i++) {
+		cum_keys[i] = cum_keys[i - 1] + (i == 100 ? uint64_t(1.9 * (1 << 16) * n) : 1);
+		position[i] = cum_keys[i] * 2;
+	}
+
+	DoubleEF<> ef(cum_keys, position, 4);
+	stringstream ss;
+	ss << ef;
+	DoubleEF<> ef_load;
+	ss >> ef_load;
+
+	for (size_t i = 0; i < n; i++) {
+		uint64_t ck, ckn, pos;
+		ef_load.get(i, ck, ckn, pos);
+		ASSERT_EQ(cum_keys[i], ck) << i;
+		ASSERT_EQ(cum_keys[i + 1], ckn) << i;
+		ASSERT_EQ(position[i], pos) << i;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <sstream>
+#include <sux/function/MultiEF.hpp>
+#include <vector>
+
+using namespace std;
+using namespace sux::function;
+
+TEST(multief_test, random) {
+	const size_t n = 100000;
+	array<vector<uint64_t>, 3> seq;
+	for (auto &s : seq) s.resize(n);
+	for (size_t i = 1; i < n; i++) {
+		seq[0][i] = seq[0][i - 1] + next() % 200;
+		seq[1][i] = seq[1][i - 1] + (next() % 100 == 0 ? next() % (1 << 30) : next() % 4);
+		seq[2][i] = seq[2][i - 1] + (next() >> 24); // 40-bit gaps: more than 56 lower bits overall
+	}
+
+	MultiEF<3> ef(seq);
+	ASSERT_EQ(n, ef.size());
+	for (size_t i = 0; i < n; i++) {
+		const auto v = ef.get(i);
+		for (size_t k = 0; k < 3; k++) ASSERT_EQ(seq[k][i], v[k]) << i << " " << k;
+	}
+
+	stringstream ss;
+	ss << ef;
+	MultiEF<3> ef_load;
+	ss >> ef_load;
+	for (size_t i = 0; i < n; i += 7) ASSERT_EQ(ef.get(i), ef_load.get(i));
+}
+
+TEST(multief_test, small) {
+	array<vector<uint64_t>, 1> seq{vector<uint64_t>{0, 0, 1, 1000, 1000000}};
+	MultiEF<1> ef(seq);
+	for (size_t i = 0; i < seq[0].size(); i++) ASSERT_EQ(seq[0][i], ef.get(i)[0]);
+
+	array<vector<uint64_t>, 2> empty;
+	MultiEF<2> ef_empty(empty);
+	ASSERT_EQ(0, ef_empty.size());
+}
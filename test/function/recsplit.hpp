@@ -5,6 +5,7 @@
 #include <cstring>
 #include <fstream>
 #include <random>
+#include <sstream>
 #include <sux/function/RecSplit.hpp>
 
 using namespace std;
@@ -135,3 +136,44 @@ TEST(recsplit_test, small_text_dump_and_load) {
 	recsplit_unit_test(rs_load, keys);
 	remove(filename);
 }
+
+TEST(recsplit_test, parallel) {
+	vector<hash128_t> keys;
+	for (size_t i = 0; i < NKEYS_TEST / 10; ++i) {
+		keys.push_back(hash128_t(next(), next()));
+	}
+	vector<hash128_t> keys1(keys), keys4(keys);
+
+	RecSplit2 rs1(keys1, 100, 1), rs4(keys4, 100, 4);
+	recsplit_unit_test(rs4, keys);
+
+	// The function must not depend on the number of threads
+	stringstream ss1, ss4;
+	ss1 << rs1;
+	ss4 << rs4;
+	ASSERT_EQ(ss1.str(), ss4.str());
+}
+
+TEST(recsplit_test, batch) {
+	vector<hash128_t> keys;
+	for (size_t i = 0; i < NKEYS_TEST / 10; ++i) {
+		keys.push_back(hash128_t(next(), next()));
+	}
+	vector<hash128_t> build(keys);
+	RecSplit2 rs(build, 100);
+
+	vector<size_t> sorted(keys.size()), unsorted(keys.size());
+	rs(keys.data(), keys.size(), sorted.data(), true);
+	rs(keys.data(), keys.size(), unsorted.data());
+	for (size_t i = 0; i < keys.size(); i++) {
+		ASSERT_EQ(rs(keys[i]), sorted[i]) << i;
+		ASSERT_EQ(sorted[i], unsorted[i]) << i;
+	}
+
+	vector<string> strings;
+	for (size_t i = 0; i < 10000; i++) strings.push_back(to_string(next()));
+	RecSplit<8> rs_str(strings, 100);
+	vector<size_t> values(strings.size());
+	rs_str(strings, values.data());
+	for (size_t i = 0; i < strings.size(); i++) ASSERT_EQ(rs_str(strings[i]), values[i]) << i;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <sux/support/SpookyV2.hpp>
+#include <vector>
+
+template <size_t LANES> static void spooky_batch_test(const size_t n) {
+	vector<vector<uint8_t>> keys(n);
+	vector<const void *> data(n);
+	vector<size_t> length(n);
+	vector<uint64_t> h1(n), h2(n);
+
+	for (size_t i = 0; i < n; i++) {
+		// Lengths cover the empty message, all tails and both short and long paths
+		keys[i].resize(i % 7 == 0 ? next() % 400 : next() % 64);
+		for (auto &c : keys[i]) c = next();
+		data[i] = keys[i].data();
+		length[i] = keys[i].size();
+		h1[i] = next();
+		h2[i] = next();
+	}
+
+	vector<uint64_t> e1(h1), e2(h2);
+	for (size_t i = 0; i < n; i++) SpookyHash::Hash128(data[i], length[i], &e1[i], &e2[i]);
+
+	SpookyHash::Hash128Batch<LANES>(data.data(), length.data(), n, h1.data(), h2.data());
+
+	for (size_t i = 0; i < n; i++) {
+		ASSERT_EQ(e1[i], h1[i]) << "at index " << i << " (length " << length[i] << ")";
+		ASSERT_EQ(e2[i], h2[i]) << "at index " << i << " (length " << length[i] << ")";
+	}
+}
+
+TEST(spooky_test, batch4) {
+	for (size_t n = 0; n <= 9; n++) spooky_batch_test<4>(n);
+	spooky_batch_test<4>(10000);
+}
+
+TEST(spooky_test, batch8) {
+	for (size_t n = 0; n <= 17; n++) spooky_batch_test<8>(n);
+	spooky_batch_test<8>(10000);
+}
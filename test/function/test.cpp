@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
 #include "../xoroshiro128pp.hpp"
+#include "doubleef.hpp"
+#include "multief.hpp"
 #include "ricebitvector.hpp"
+#include "spooky.hpp"
 
 #define LEAF 4
 #define NKEYS_TEST 1000000
 #include "recsplit.hpp"
+#include "deltarecsplit.hpp"
 
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);